@@ -9,14 +9,6 @@
 
 #include "Amiga.h"
 
-//
-// Static class variables
-//
-
-bool Amiga::debugMode = false;
-EventID Amiga::inspectionTarget = INS_NONE;
-
-
 //
 // Emulator thread
 //
@@ -168,6 +160,7 @@ Amiga::getConfig()
     config.denise = denise.getConfig();
     config.serialPort = serialPort.getConfig();
     config.blitter = agnus.blitter.getConfig(); 
+    config.copper = agnus.copper.getConfig();
     config.diskController = paula.diskController.getConfig();
     config.df0 = df0.getConfig();
     config.df1 = df1.getConfig();
@@ -199,6 +192,8 @@ Amiga::updateStats()
 
     stats.mem = mem.getStats();
     stats.agnus = agnus.getStats();
+    stats.blitter = agnus.blitter.getStats();
+    stats.copper = agnus.copper.getStats();
     stats.denise = denise.getStats();
     stats.uart = paula.uart.getStats();
     stats.disk = paula.diskController.getStats();
@@ -215,6 +210,8 @@ Amiga::clearStats()
     memset(&stats, 0, sizeof(stats));
     mem.clearStats();
     agnus.clearStats();
+    agnus.blitter.clearStats();
+    agnus.copper.clearStats();
     denise.clearStats();
     paula.uart.clearStats();
     paula.diskController.clearStats();
@@ -329,6 +326,12 @@ Amiga::configure(ConfigOption option, long value)
             denise.setClxPlfPlf(value);
             break;
 
+        case VA_RENDER_THREAD:
+
+            if (current.denise.renderThread == value) return true;
+            denise.setRenderThread(value);
+            break;
+
         case VA_FILTER_ACTIVATION:
 
             if (!isFilterActivation(value)) {
@@ -358,6 +361,18 @@ Amiga::configure(ConfigOption option, long value)
             if (current.blitter.accuracy == value) return true;
             agnus.blitter.setAccuracy(value);
             break;
+
+        case VA_BLITTER_PARALLEL:
+
+            if (current.blitter.parallel == value) return true;
+            agnus.blitter.setParallel(value);
+            break;
+
+        case VA_COPPER_PRECOMPUTE:
+
+            if (current.copper.precompute == value) return true;
+            agnus.copper.setPrecompute(value);
+            break;
             
         case VA_FIFO_BUFFERING:
 
@@ -529,6 +544,9 @@ Amiga::_powerOn()
     // Clear all runloop flags
     runLoopCtrl = 0;
 
+    // Skip the boot process if a cached boot state exists
+    if (bootCache) restoreBootState();
+
     // Update the recorded debug information
     inspect();
 
@@ -969,6 +987,12 @@ Amiga::runLoop()
                 clearControlFlags(RL_SNAPSHOT);
             }
             
+            // Are we requested to record the boot state?
+            if (runLoopCtrl & RL_BOOT_SNAPSHOT) {
+                recordBootState();
+                clearControlFlags(RL_BOOT_SNAPSHOT);
+            }
+
             // Are we requested to update the debugger info structs?
             if (runLoopCtrl & RL_INSPECT) {
                 inspect();
@@ -1004,6 +1028,77 @@ Amiga::runLoop()
     } while (1);
 }
 
+void
+Amiga::bootCacheReached(BootCachePoint point)
+{
+    if (!bootCachePending || point != bootCache->getPoint()) return;
+
+    if (point == BOOT_CACHE_FRAME && agnus.frame < bootCache->getFrame()) return;
+
+    bootCachePending = false;
+    setControlFlags(RL_BOOT_SNAPSHOT);
+}
+
+void
+Amiga::restoreBootState()
+{
+    assert(bootCache != NULL);
+
+    bootCacheKey = bootCache->computeKey(*this);
+
+    Snapshot *snapshot = bootCache->lookup(bootCacheKey);
+
+    if (snapshot) {
+
+        debug("Restoring cached boot state %016llx\n", (unsigned long long)bootCacheKey);
+
+        if (bootCache->getPoint() == BOOT_CACHE_DISK_DMA) {
+
+            // Keep the inserted disks (the cached disks have not been read yet)
+            Disk *disks[4];
+            for (int i = 0; i < 4; i++) { disks[i] = df[i]->disk; df[i]->disk = NULL; }
+
+            loadFromSnapshotUnsafe(snapshot);
+
+            for (int i = 0; i < 4; i++) {
+                if (df[i]->disk) delete df[i]->disk;
+                df[i]->disk = disks[i];
+            }
+
+        } else {
+
+            loadFromSnapshotUnsafe(snapshot);
+        }
+        bootCachePending = false;
+
+    } else {
+
+        bootCachePending = true;
+    }
+}
+
+void
+Amiga::recordBootState()
+{
+    if (bootCache) bootCache->store(bootCacheKey, Snapshot::makeWithAmiga(this));
+}
+
+void
+Amiga::executeFrame()
+{
+    Frame frame = agnus.frame;
+
+    while (agnus.frame == frame) {
+
+        cpu.execute();
+
+        if (runLoopCtrl & RL_BOOT_SNAPSHOT) {
+            recordBootState();
+            clearControlFlags(RL_BOOT_SNAPSHOT);
+        }
+    }
+}
+
 void
 Amiga::dumpClock()
 {
@@ -1032,3 +1127,45 @@ Amiga::dumpClock()
              agnus.pos.v, agnus.pos.h, agnus.pos.v, agnus.pos.h, agnus.frame);
     plainmsg("\n");
 }
+
+uint64_t
+Amiga::stateHash()
+{
+    uint64_t hash = fnv_1a_init64();
+
+    for (HardwareComponent *c : subComponents) {
+        hash = fnv_1a_it64(hash, componentHash(c));
+    }
+
+    return hash;
+}
+
+uint64_t
+Amiga::componentHash(HardwareComponent *c, bool masked)
+{
+    // Ram is covered by a separate hash which is updated incrementally
+    if (c == &mem) return mem.ramHash();
+
+    size_t size = c->size();
+    if (hashBuffer.size() < size) hashBuffer.resize(size);
+
+    size = masked ? c->saveMasked(hashBuffer.data()) : c->save(hashBuffer.data());
+    return fnv_1a_64(hashBuffer.data(), size);
+}
+
+uint64_t
+Amiga::frameHash()
+{
+    PixelEngine &pixelEngine = denise.pixelEngine;
+    int32_t *data = pixelEngine.getLatestLongFrame().data;
+
+    // Hash indexed frames in RGBA format to get the same result in both modes
+    if (pixelEngine.getFrameOutput() == FRAME_OUTPUT_INDEXED) {
+
+        frameHashBuffer.resize(PIXELS);
+        pixelEngine.expandFrame(pixelEngine.getLatestIndexedLongFrame(), frameHashBuffer.data());
+        data = frameHashBuffer.data();
+    }
+
+    return fnv_1a_64((uint8_t *)data, PIXELS * sizeof(int));
+}
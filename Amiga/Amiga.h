@@ -40,6 +40,9 @@
 #include "ExtFile.h"
 #include "Snapshot.h"
 #include "ADFFile.h"
+#include "BootCache.h"
+#include "Capture.h"
+#include "SharedExport.h"
 
 /* A complete virtual Amiga
  * This class is the most prominent one of all. To run the emulator, it is
@@ -65,7 +68,7 @@ public:
      * If the event is EVENT_NONE, no action is taken. If an INS_xxx event is
      * scheduled, inspect() is called on a certain Amiga component.
      */
-    static EventID inspectionTarget;
+    EventID inspectionTarget = INS_NONE;
     
 private:
     
@@ -75,7 +78,7 @@ private:
      * are performed that are usually left out. E.g., the CPU checks for
      * breakpoints and records the executed instruction in it's trace buffer.
      */
-    static bool debugMode;
+    bool debugMode = false;
     
     
     //
@@ -216,6 +219,48 @@ private:
     
     // Storage for user-taken snapshots
     vector<Snapshot *> userSnapshots;
+
+
+    //
+    // Boot cache
+    //
+
+private:
+
+    // Cache storing the state of a booted Amiga (NULL if not used)
+    BootCache *bootCache = NULL;
+
+    // Indicates if a boot state needs to be recorded
+    bool bootCachePending = false;
+
+    // Lookup key of the boot state to be recorded
+    uint64_t bootCacheKey = 0;
+
+
+    //
+    // Capturing
+    //
+
+private:
+
+    // Video and audio recorder (NULL if not recording)
+    Capture *capture = NULL;
+
+    // Shared memory export (NULL if not exporting)
+    SharedExport *sharedExport = NULL;
+
+
+    //
+    // State hashing
+    //
+
+private:
+
+    // Scratch buffer for serializing components inside stateHash()
+    vector<uint8_t> hashBuffer;
+
+    // Scratch buffer for expanding indexed frames inside frameHash()
+    vector<int32_t> frameHashBuffer;
     
     
     //
@@ -225,6 +270,15 @@ private:
 public:
     
     bool debugDMA = false; // REMOVE AFTER DEBUGGING
+
+    /* Debug levels that can be changed at runtime.
+     * All other debug levels are compile-time constants (see va_config.h).
+     * They are stored per instance to keep multiple emulator instances from
+     * interfering with each other.
+     */
+    int ocsRegDebug = 2;  // General OCS register debugging
+    int ciaRegDebug = 2;  // CIA registers
+    int intDebug = 2;     // Interrupts
     
     
     //
@@ -439,6 +493,12 @@ public:
      */
     void runLoop();
 
+    /* Emulates the Amiga until the next frame begins.
+     * This function is utilized by the headless tools which drive the emulator
+     * directly instead of launching the emulator thread.
+     */
+    void executeFrame();
+
     
     //
     // Managing emulation speed
@@ -548,13 +608,85 @@ public:
     void deleteSnapshot(vector<Snapshot *> &storage, unsigned nr);
     void deleteAutoSnapshot(unsigned nr) { deleteSnapshot(autoSnapshots, nr); }
     void deleteUserSnapshot(unsigned nr) { deleteSnapshot(userSnapshots, nr); }
+
+
+    //
+    // Using the boot cache
+    //
+
+public:
+
+    /* Attaches a boot cache.
+     * If a boot cache is attached, powerOn() restores a previously recorded
+     * boot state if one exists for the current configuration. Otherwise, the
+     * boot state is recorded when the point configured in the cache is
+     * reached. The cache is not owned by the Amiga and can be shared.
+     */
+    BootCache *getBootCache() { return bootCache; }
+    void setBootCache(BootCache *cache) { bootCache = cache; }
+
+    /* Informs the boot cache logic that a certain point has been reached.
+     * If a boot state is pending and the point matches the configured one,
+     * the state is recorded after the current instruction has completed.
+     */
+    void bootCacheReached(BootCachePoint point);
+
+private:
+
+    // Restores a cached boot state or prepares for recording one
+    void restoreBootState();
+
+    // Records the current state in the boot cache
+    void recordBootState();
+
+
+    //
+    // Capturing the output
+    //
+
+public:
+
+    /* Attaches a capture. The capture is not owned by the Amiga. This
+     * function is called by Capture::start() and Capture::stop() and must not
+     * be called while the emulator is running.
+     */
+    Capture *getCapture() { return capture; }
+    void setCapture(Capture *value) { capture = value; }
+
+    /* Attaches a shared memory export. The export is not owned by the Amiga.
+     * This function is called by SharedExport::attach() and
+     * SharedExport::detach() and must not be called while the emulator is
+     * running.
+     */
+    SharedExport *getSharedExport() { return sharedExport; }
+    void setSharedExport(SharedExport *value) { sharedExport = value; }
     
     
     //
     // Debugging the emulator
     //
+
+public:
     
     void dumpClock();
+
+    /* Computes a hash value over the current emulator state.
+     * The hash covers the internal state of all sub-components as well as
+     * the contents of Ram. Host dependent items like the synchronization
+     * timer are not taken into account. Two emulator instances that have
+     * executed the same code in the same way produce the same hash.
+     */
+    uint64_t stateHash();
+
+    /* Computes a hash value over the internal state of a single component.
+     * Memory is excluded from the serialized state and represented by its
+     * incrementally updated Ram hash. If masked is true, configuration items
+     * are not taken into account.
+     */
+    uint64_t componentHash(HardwareComponent *c, bool masked = false);
+
+    // Computes a hash value over the most recently finished long frame
+    uint64_t frameHash();
     
 };
 
@@ -45,22 +45,26 @@ typedef enum : long
     VA_FILTER_TYPE,
     VA_BLITTER_ACCURACY,
     VA_FIFO_BUFFERING,
-    VA_SERIAL_DEVICE
+    VA_SERIAL_DEVICE,
+    VA_BLITTER_PARALLEL,
+    VA_COPPER_PRECOMPUTE,
+    VA_RENDER_THREAD
 }
 ConfigOption;
 
 inline bool isConfigOption(long value)
 {
-    return value >= VA_AGNUS_REVISION && value <= VA_SERIAL_DEVICE;
+    return value >= VA_AGNUS_REVISION && value <= VA_RENDER_THREAD;
 }
 
 typedef enum
 {
-    RL_SNAPSHOT           = 0b00001,
-    RL_INSPECT            = 0b00010,
-    RL_BREAKPOINT_REACHED = 0b00100,
-    RL_WATCHPOINT_REACHED = 0b01000,
-    RL_STOP               = 0b10000
+    RL_SNAPSHOT           = 0b000001,
+    RL_INSPECT            = 0b000010,
+    RL_BREAKPOINT_REACHED = 0b000100,
+    RL_WATCHPOINT_REACHED = 0b001000,
+    RL_STOP               = 0b010000,
+    RL_BOOT_SNAPSHOT      = 0b100000
 }
 RunLoopControlFlag;
 
@@ -78,6 +82,7 @@ typedef struct
     AgnusConfig agnus;
     DeniseConfig denise;
     BlitterConfig blitter;
+    CopperConfig copper;
     SerialPortConfig serialPort;
     DiskControllerConfig diskController;
     DriveConfig df0;
@@ -103,6 +108,8 @@ typedef struct
 {
     MemoryStats mem;
     AgnusStats agnus;
+    BlitterStats blitter;
+    CopperStats copper;
     DeniseStats denise;
     UARTStats uart;
     DiskControllerStats disk;
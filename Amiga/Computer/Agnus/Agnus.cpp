@@ -9,6 +9,10 @@
 
 #include "Amiga.h"
 
+EventID Agnus::bplDMA[2][7][HPOS_CNT];
+uint8_t Agnus::fetchUnitNr[2][HPOS_CNT];
+EventID Agnus::dasDMA[64][HPOS_CNT];
+
 Agnus::Agnus(Amiga& ref) : AmigaComponent(ref)
 {
     setDescription("Agnus");
@@ -22,7 +26,9 @@ Agnus::Agnus(Amiga& ref) : AmigaComponent(ref)
 
     config.revision = AGNUS_8372;
 
-    initLookupTables();
+    // Set up the shared lookup tables when the first instance is created
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, initLookupTables);
 }
 
 void
@@ -92,7 +98,7 @@ Agnus::initBplEventTableHires()
     }
 
     for (int i = 0; i <= 0xD8; i++) {
-        fetchUnitNr[0][i] = i % 4;
+        fetchUnitNr[1][i] = i % 4;
     }
 }
 
@@ -366,6 +372,7 @@ Agnus::copperCanRun()
     // Deny access if the bus is already in use
     if (busOwner[pos.h] != BUS_NONE) {
         debug(COP_DEBUG, "Copper blocked (bus busy)\n");
+        copper.frameStats.blocked++;
         return false;
     }
 
@@ -378,6 +385,7 @@ Agnus::copperCanDoDMA()
     // Deny access in cycle $E0
     if (unlikely(pos.h == 0xE0)) {
         debug(COP_DEBUG, "Copper blocked (at $E0)\n");
+        copper.frameStats.blocked++;
         return false;
     }
 
@@ -1660,6 +1668,9 @@ Agnus::setBPLCON0(uint16_t oldValue, uint16_t newValue)
     // Update variable bplcon0AtDDFStrt if DDFSTRT has not been reached yet
     if (pos.h < ddfstrtReached) bplcon0AtDDFStrt = newValue;
 
+    // Abort a precomputed Copper run if bitplane DMA starts to steal its cycles
+    if (copper.hasActiveRun() && Copper::bplDmaBlocksCopper(newValue)) copper.abortRun();
+
     // Update the bpl event table in the next rasterline
     hsyncActions |= HSYNC_UPDATE_BPL_TABLE;
 
@@ -1766,12 +1777,42 @@ Agnus::executeUntil(Cycle targetClock)
 
     } else {
 
-        // Execute DMA cycles one after another
-        for (DMACycle i = 0; i < dmaCycles; i++) execute();
+        // Execute DMA cycles one after another (allow Blitter batching)
+        batchLimit = targetClock;
+        while (clock < targetClock) execute();
+        batchLimit = 0;
     }
 }
 #endif
 
+bool
+Agnus::advanceForBlitter(EventID id)
+{
+    Cycle next = clock + DMA_CYCLES(1);
+
+    // Only advance inside the time frame covered by executeUntil()
+    if (next >= batchLimit) return false;
+
+    // The Blitter event must be due in the next cycle
+    if (slot[BLT_SLOT].id != id || slot[BLT_SLOT].triggerCycle > next) return false;
+
+    /* No other event must be due. Bitplane DMA and disk, audio, and sprite DMA
+     * are scheduled via the BPL and DAS jump tables. Hence, there is no DMA
+     * activity in the next cycle if the BPL and DAS slots are not due. The CPU
+     * cannot interfere, because it is suspended while executeUntil() runs.
+     */
+    for (unsigned i = 0; i <= SEC_SLOT; i++) {
+        if (i != BLT_SLOT && slot[i].triggerCycle <= next) return false;
+    }
+
+    // Advance the internal clock and the horizontal counter
+    assert(pos.h < HPOS_MAX);
+    clock = next;
+    pos.h++;
+
+    return true;
+}
+
 void
 Agnus::executeUntilBusIsFree()
 {
@@ -1789,6 +1830,7 @@ Agnus::executeUntilBusIsFree()
             posh = pos.h;
             execute();
             if (++delay == 2) bls = true;
+            if (busOwner[posh] == BUS_BLITTER) blitter.cpuWasBlocked();
 
         } while (busOwner[posh] != BUS_NONE);
 
@@ -1895,6 +1937,9 @@ Agnus::hsyncHandler()
 {
     assert(pos.h == 0 || pos.h == HPOS_MAX + 1);
 
+    // Hand over the color changes precomputed by the Copper
+    copper.deliverRun(pos.v);
+
     // Let Denise draw the current line
     denise.endOfLine(pos.v);
 
@@ -2056,6 +2101,9 @@ Agnus::vsyncHandler()
     // Update statistics
     amiga.updateStats();
 
+    // Check if the boot state should be recorded
+    amiga.bootCacheReached(BOOT_CACHE_FRAME);
+
     // Prepare to take a snapshot once in a while
     if (amiga.snapshotIsDue()) amiga.signalSnapshot();
 
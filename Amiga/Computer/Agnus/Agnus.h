@@ -90,6 +90,10 @@ public:
     // Static lookup tables
     //
 
+    /* The lookup tables don't depend on the emulator state. They are shared
+     * by all instances and set up once when the first instance is created.
+     */
+
     /* Bitplane DMA events as they appear in a single rasterline.
      *
      * Parameters: bitplaneDMA[Resolution][Bitplanes][Cycle]
@@ -102,7 +106,7 @@ public:
      * Depending on the current resoution and BPU value, a segment of this
      * lookup table is copied into the event table.
      */
-    EventID bplDMA[2][7][HPOS_CNT];
+    static EventID bplDMA[2][7][HPOS_CNT];
 
     /* Fetch unit cycle numbers.
      *
@@ -115,7 +119,7 @@ public:
      * cycle inside the fetch unit. The first cycle in a fetch unit in numbered
      * 0, the second cycle is numbered 1 and so on.
      */
-    uint8_t fetchUnitNr[2][HPOS_CNT];
+    static uint8_t fetchUnitNr[2][HPOS_CNT];
 
     /* Disk, Audio, Sprite DMA events as they appear in a single rasterline.
      *
@@ -127,7 +131,7 @@ public:
      * Depending on the current resoution and BPU value, a segment of this
      * lookup table is copied into the event table.
      */
-    EventID dasDMA[64][HPOS_CNT];
+    static EventID dasDMA[64][HPOS_CNT];
 
 
     //
@@ -213,6 +217,14 @@ public:
 
     // Agnus has been emulated up to this clock cycle.
     Cycle clock;
+
+    /* Upper bound for batched Blitter execution.
+     * While executeUntil() is running, this variable holds the target clock.
+     * Up to this cycle, the Blitter may process multiple micro-instructions
+     * within a single event service (see advanceForBlitter()). In all other
+     * situations, the value is 0 which disables batching.
+     */
+    Cycle batchLimit = 0;
     
     /* The frame counter.
      * The value is increased on every VSYNC action.
@@ -482,10 +494,10 @@ public:
     
     Agnus(Amiga& ref);
 
-    void initLookupTables();
-    void initBplEventTableLores();
-    void initBplEventTableHires();
-    void initDasEventTable();
+    static void initLookupTables();
+    static void initBplEventTableLores();
+    static void initBplEventTableHires();
+    static void initDasEventTable();
 
     template <class T>
     void applyToPersistentItems(T& worker)
@@ -932,6 +944,16 @@ public:
     // Executes the device until the CPU can acquire the bus
     void executeUntilBusIsFree();
 
+    /* Advances the device by a single cycle on behalf of the Blitter
+     * The function is called by the Blitter after it has processed a micro-
+     * instruction. The clock is only advanced if the Blitter event with the
+     * specified id is due in the next cycle and no other event is. In this
+     * case, no other DMA channel can allocate the bus in the next cycle and
+     * the Blitter can process the next micro-instruction right away.
+     * Returns false if the clock hasn't been advanced.
+     */
+    bool advanceForBlitter(EventID id);
+
     // Schedules a register to change
     void recordRegisterChange(Cycle delay, uint32_t addr, uint16_t value);
 
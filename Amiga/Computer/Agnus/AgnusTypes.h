@@ -193,6 +193,36 @@ typedef struct
 }
 AgnusStats;
 
+typedef struct
+{
+    bool precompute;
+}
+CopperConfig;
+
+// Number of rasterlines in the Copper statistics (lines of a long frame)
+#define COP_LINES 313
+
+typedef struct
+{
+    // Executed commands
+    long moves;
+    long waits;
+    long skips;
+
+    // Commands covered by precomputed runs
+    long precomputed;
+
+    // Cycles in which the Copper was blocked (bus in use or cycle $E0)
+    long blocked;
+
+    // MOVEs that stopped the Copper because of the danger bit
+    long violations;
+
+    // Executed commands per rasterline
+    long lines[COP_LINES];
+}
+CopperStats;
+
 typedef struct
 {
     bool active;
@@ -204,15 +234,76 @@ typedef struct
     uint16_t cop2ins;
     int16_t length1;
     int16_t length2;
+
+    // Statistics of the most recently completed frame
+    CopperStats frame;
 }
 CopperInfo;
 
 typedef struct
 {
     int accuracy;
+    bool parallel;
 }
 BlitterConfig;
 
+// Blitter implementation that processed a blit
+typedef enum : long
+{
+    BLT_ENGINE_FAST,  // Accuracy level 0
+    BLT_ENGINE_FAKE,  // Accuracy level 1
+    BLT_ENGINE_SLOW,  // Accuracy level 2
+    BLT_ENGINE_COUNT
+}
+BlitterEngine;
+
+// Number of size classes in the Blitter statistics
+#define BLT_SIZE_CLASSES 8
+
+/* A single blit recorded by the Blitter
+ * The size class groups blits by the number of words (width * height):
+ * Class 0 covers less than 16 words. Each further class covers four times
+ * as many words as the previous one. The last class covers all larger blits.
+ */
+typedef struct
+{
+    int64_t start;
+    int64_t end;
+    uint16_t bltcon0;
+    uint16_t bltcon1;
+    uint16_t width;
+    uint16_t height;
+    uint8_t channels;
+    uint8_t minterm;
+    BlitterEngine engine;
+
+    // Number of DMA cycles the CPU had to wait for the Blitter
+    long stolen;
+}
+BlitRecord;
+
+typedef struct
+{
+    long copyBlits;
+    long lineBlits;
+
+    // Number of processed words (width * height)
+    long words;
+
+    // Number of master cycles the Blitter was running
+    long cycles;
+
+    // Number of DMA cycles the CPU had to wait for the Blitter
+    long stolen;
+
+    // Histograms
+    long engine[BLT_ENGINE_COUNT];
+    long channels[16];
+    long size[BLT_SIZE_CLASSES];
+    long minterm[256];
+}
+BlitterStats;
+
 typedef struct
 {
     bool active;
@@ -237,6 +328,9 @@ typedef struct
     uint16_t dhold;
     bool bbusy;
     bool bzero;
+
+    // Statistics of the most recently completed frame
+    BlitterStats frame;
 }
 BlitterInfo;
 
@@ -9,12 +9,49 @@
 
 #include "Amiga.h"
 
+uint8_t Blitter::fillPattern[2][2][256];
+uint8_t Blitter::nextCarryIn[2][256];
+
 Blitter::Blitter(Amiga& ref) : AmigaComponent(ref)
 {
     setDescription("Blitter");
-    
-    // Initialize fill pattern lookup tables
-    
+
+    // Set up the shared lookup tables when the first instance is created
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, initFillTables);
+
+    config.parallel = false;
+
+    memset(&stats, 0, sizeof(stats));
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&lastFrameStats, 0, sizeof(lastFrameStats));
+
+    pthread_mutex_init(&workerLock, NULL);
+    pthread_cond_init(&workerCond, NULL);
+}
+
+Blitter::~Blitter()
+{
+    // Terminate the worker thread
+    if (workerCreated) {
+
+        sync();
+
+        pthread_mutex_lock(&workerLock);
+        workerExit = true;
+        pthread_cond_broadcast(&workerCond);
+        pthread_mutex_unlock(&workerLock);
+
+        pthread_join(worker, NULL);
+    }
+
+    pthread_cond_destroy(&workerCond);
+    pthread_mutex_destroy(&workerLock);
+}
+
+void
+Blitter::initFillTables()
+{
     // Inclusive fill
     for (unsigned carryIn = 0; carryIn < 2; carryIn++) {
         
@@ -53,15 +90,23 @@ Blitter::_powerOn()
 void
 Blitter::_reset()
 {
+    sync();
+
     RESET_SNAPSHOT_ITEMS
 
     copycount = 0;
     linecount = 0;
+
+    numRecords = 0;
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&lastFrameStats, 0, sizeof(lastFrameStats));
 }
 
 void
 Blitter::_inspect()
 {
+    sync();
+
     // Prevent external access to variable 'info'
     pthread_mutex_lock(&lock);
     
@@ -86,6 +131,7 @@ Blitter::_inspect()
     info.dhold = dhold;
     info.bbusy = bbusy;
     info.bzero = bzero;
+    info.frame = lastFrameStats;
     
     pthread_mutex_unlock(&lock);
 }
@@ -93,7 +139,10 @@ Blitter::_inspect()
 void
 Blitter::_dump()
 {
+    sync();
+
     plainmsg("  Accuracy: %d\n", config.accuracy);
+    plainmsg("  Parallel: %s\n", config.parallel ? "yes" : "no");
     plainmsg("\n");
     plainmsg("   bltcon0: %X\n", bltcon0);
     plainmsg("\n");
@@ -435,20 +484,32 @@ Blitter::serviceEvent(EventID id)
             startBlit();
             break;
 
+        /* In the following states, the Blitter executes a micro-instruction
+         * in each cycle. If no other component is active in the next cycle,
+         * the next micro-instruction is processed right away. This saves the
+         * overhead of servicing the event again without affecting timing.
+         */
         case BLT_COPY_SLOW:
 
-            debug(BLT_DEBUG, "Instruction %d:%d\n", bltconUSE(), bltpc);
-            (this->*copyBlitInstr[bltconUSE()][0][bltconFE()][bltpc])();
+            do {
+                debug(BLT_DEBUG, "Instruction %d:%d\n", bltconUSE(), bltpc);
+                (this->*copyBlitInstr[bltconUSE()][0][bltconFE()][bltpc])();
+            } while (agnus.advanceForBlitter(id));
             break;
 
         case BLT_COPY_FAKE:
 
-            debug(BLT_DEBUG, "Faked instruction %d:%d\n", bltconUSE(), bltpc);
-            (this->*copyBlitInstr[bltconUSE()][1][bltconFE()][bltpc])();
+            do {
+                debug(BLT_DEBUG, "Faked instruction %d:%d\n", bltconUSE(), bltpc);
+                (this->*copyBlitInstr[bltconUSE()][1][bltconFE()][bltpc])();
+            } while (agnus.advanceForBlitter(id));
             break;
 
         case BLT_LINE_FAKE:
-            (this->*lineBlitInstr[bltpc])();
+
+            do {
+                (this->*lineBlitInstr[bltpc])();
+            } while (agnus.advanceForBlitter(id));
             break;
 
         default:
@@ -461,7 +522,9 @@ Blitter::serviceEvent(EventID id)
 void
 Blitter::vsyncHandler()
 {
-
+    // Finish the statistics of the current frame
+    lastFrameStats = frameStats;
+    memset(&frameStats, 0, sizeof(frameStats));
 }
 
 uint16_t
@@ -786,6 +849,27 @@ Blitter::startBlit()
     check1 = fnv_1a_init32();
     check2 = fnv_1a_init32();
 
+    // Start a new profiling record
+    record.start = agnus.clock;
+    record.bltcon0 = bltcon0;
+    record.bltcon1 = bltcon1;
+    record.width = bltsizeW;
+    record.height = bltsizeH;
+    record.channels = bltconUSE();
+    record.minterm = bltcon0 & 0xFF;
+    record.engine = (BlitterEngine)level;
+    record.stolen = 0;
+
+    // Abort a precomputed Copper run if the blit might modify the Copper list
+    if (unlikely(copper.hasActiveRun())) {
+
+        uint32_t lo, hi;
+        bool hit = bltconLINE() || (bltconUSED() &&
+                   (!footprint(bltdpt, bltdmod, lo, hi) || (lo < mem.copHi && hi > mem.copLo)));
+
+        if (hit) copper.abortRun();
+    }
+
     if (bltconLINE()) {
 
         linecount++;
@@ -836,6 +920,9 @@ Blitter::endBlit()
     // Clear the Blitter slot
     agnus.cancel<BLT_SLOT>();
 
+    // Record the blit
+    recordBlit();
+
     // Dump checksums if requested
     // if (bltsizeW != 1 || bltsizeH != 4)
     {
@@ -846,6 +933,57 @@ Blitter::endBlit()
     copper.blitterDidTerminate();
 }
 
+void
+Blitter::recordBlit()
+{
+    record.end = agnus.clock;
+
+    // Store the record (prevent external access while doing so)
+    pthread_mutex_lock(&lock);
+    records[recordPtr] = record;
+    recordPtr = (recordPtr + 1) % maxRecords;
+    if (numRecords < maxRecords) numRecords++;
+    pthread_mutex_unlock(&lock);
+
+    updateStats(stats);
+    updateStats(frameStats);
+}
+
+void
+Blitter::updateStats(BlitterStats &s)
+{
+    long words = record.width * record.height;
+    bool line = record.bltcon1 & 1;
+
+    if (line) s.lineBlits++; else s.copyBlits++;
+    s.words += words;
+    s.cycles += record.end - record.start;
+    s.stolen += record.stolen;
+
+    // Determine the size class
+    int size = 0;
+    while (size < BLT_SIZE_CLASSES - 1 && words >= (16L << (2 * size))) size++;
+
+    s.engine[record.engine]++;
+    s.channels[record.channels]++;
+    s.size[size]++;
+    if (!line) s.minterm[record.minterm]++;
+}
+
+size_t
+Blitter::getRecords(BlitRecord *buffer, size_t max)
+{
+    pthread_mutex_lock(&lock);
+
+    size_t count = MIN(max, (size_t)numRecords);
+    for (size_t i = 0; i < count; i++) {
+        buffer[i] = records[(recordPtr + maxRecords - count + i) % maxRecords];
+    }
+
+    pthread_mutex_unlock(&lock);
+    return count;
+}
+
 void
 Blitter::kill()
 {
@@ -862,10 +1000,8 @@ template void Blitter::pokeBLTSIZE<POKE_COPPER>(uint16_t value);
 void
 Blitter::beginLineBlit(int level)
 {
-    static bool verbose = true;
-
-    if (verbose) {
-        verbose = false;
+    if (verboseLine) {
+        verboseLine = false;
         debug("Performing level %d line blits.\n", level);
     }
 
@@ -880,10 +1016,8 @@ Blitter::beginLineBlit(int level)
 void
 Blitter::beginCopyBlit(int level)
 {
-    static bool verbose = true;
-
-    if (verbose) {
-        verbose = false;
+    if (verboseCopy) {
+        verboseCopy = false;
         debug("Performing level %d copy blits.\n", level);
     }
 
@@ -22,6 +22,11 @@
  *          Uses up bus cycles like the real Blitter does.
  *
  * Level 0 and 1 invoke the FastBlitter. Level 2 invokes the SlowBlitter.
+ *
+ * If the parallel Blitter is enabled, long copy blits of level 0 and 1 are
+ * handed over to a worker thread. The emulator thread continues until another
+ * component touches the Chip Ram region of the blit, writes into a Blitter
+ * register, or reads the zero flag. In this case, it waits for the worker.
  */
 
 class Blitter : public AmigaComponent {
@@ -32,9 +37,9 @@ class Blitter : public AmigaComponent {
     // Information shown in the GUI inspector panel
     BlitterInfo info;
 
-    // The fill pattern lookup tables
-    uint8_t fillPattern[2][2][256];     // [inclusive/exclusive][carry in][data]
-    uint8_t nextCarryIn[2][256];        // [carry in][data]
+    // The fill pattern lookup tables (shared by all instances)
+    static uint8_t fillPattern[2][2][256];     // [inclusive/exclusive][carry in][data]
+    static uint8_t nextCarryIn[2][256];        // [carry in][data]
 
 
     //
@@ -81,8 +86,21 @@ class Blitter : public AmigaComponent {
     // Fast Blitter
     //
 
-    // The Fast Blitter's blit functions
-    void (Blitter::*blitfunc[32])(void);
+    // The Fast Blitter's line functions (indexed by SUD, SUL, AUL, and SING)
+    void (Blitter::*linefunc[16])(void);
+
+    // Maximum number of words in a row (ECS)
+    static const int maxRowWords = 2048;
+
+    /* Row buffers used by the copy blit kernels
+     * The buffers store the words of a row in processing order and native
+     * byte order, starting at index 1. Index 0 holds the last word of the
+     * previous row which is shifted into the first word by the barrel shifter.
+     */
+    uint16_t rowA[maxRowWords + 1];
+    uint16_t rowB[maxRowWords + 1];
+    uint16_t rowC[maxRowWords + 1];
+    uint16_t rowD[maxRowWords + 1];
 
 
     //
@@ -123,6 +141,31 @@ class Blitter : public AmigaComponent {
     bool lockD;
 
 
+    //
+    // Parallel Blitter
+    //
+
+    // Minimum number of words a copy blit needs to run on the worker thread
+    static const int parallelMinWords = 2048;
+
+    // The worker thread
+    pthread_t worker;
+    bool workerCreated = false;
+
+    // Used to hand over blits to the worker thread
+    pthread_mutex_t workerLock;
+    pthread_cond_t workerCond;
+    bool jobPending = false;
+    bool jobDone = true;
+    bool workerExit = false;
+
+    // Indicates if a blit is running on the worker thread
+    bool parallelRunning = false;
+
+    // Indicates if the executing code runs on the worker thread
+    bool inWorker = false;
+
+
     //
     // Flags
     //
@@ -161,6 +204,34 @@ private:
     uint32_t check1;
     uint32_t check2;
 
+    // Indicates if the selected Blitter level still needs to be reported
+    bool verboseLine = true;
+    bool verboseCopy = true;
+    bool verboseSlowCopy = true;
+
+
+    //
+    // Profiling
+    //
+
+    // Maximum number of stored blit records
+    static const int maxRecords = 256;
+
+    // Ring buffer storing the most recent blits
+    BlitRecord records[maxRecords];
+    int recordPtr = 0;
+    int numRecords = 0;
+
+    // The record of the current blit
+    BlitRecord record;
+
+    // Statistics since the last call to clearStats()
+    BlitterStats stats;
+
+    // Statistics of the current and the most recently completed frame
+    BlitterStats frameStats;
+    BlitterStats lastFrameStats;
+
 
     //
     // Constructing and destructiong
@@ -169,6 +240,10 @@ private:
 public:
     
     Blitter(Amiga& ref);
+    ~Blitter();
+
+    // Initializes the shared fill pattern lookup tables
+    static void initFillTables();
 
     void initFastBlitter();
     void initSlowBlitter();
@@ -262,6 +337,10 @@ public:
     int getAccuracy() { return config.accuracy; }
     void setAccuracy(int level) { config.accuracy = level; }
 
+    // Enables or disables the parallel Blitter
+    bool getParallel() { return config.parallel; }
+    void setParallel(bool value) { config.parallel = value; }
+
 
     //
     // Methods from HardwareComponent
@@ -271,18 +350,37 @@ private:
 
     void _initialize() override;
     void _powerOn() override;
+    void _powerOff() override { sync(); }
+    void _pause() override { sync(); }
     void _reset() override;
     void _inspect() override;
     void _dump() override;
     size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
     size_t _load(uint8_t *buffer) override { LOAD_SNAPSHOT_ITEMS }
     size_t _save(uint8_t *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    size_t willLoadFromBuffer(uint8_t *buffer) override { sync(); return 0; }
+    size_t willSaveToBuffer(uint8_t *buffer) override { sync(); return 0; }
 
 public:
 
     // Returns the result of the most recent call to inspect()
     BlitterInfo getInfo();
 
+    // Returns statistical information about the current activiy
+    BlitterStats getStats() { return stats; }
+
+    // Resets the collected statistical information
+    void clearStats() { memset(&stats, 0, sizeof(stats)); }
+
+    /* Returns the most recent blits
+     * Copies up to max records into the provided buffer, starting with the
+     * oldest one. Returns the number of copied records.
+     */
+    size_t getRecords(BlitRecord *buffer, size_t max);
+
+    // Called by Agnus for each DMA cycle the CPU waits for the Blitter
+    void cpuWasBlocked() { record.stolen++; }
+
 
     //
     // Accessing properties
@@ -297,7 +395,7 @@ public:
     bool isBusy() { return bbusy; }
 
     // Returns the value of the zero flag
-    bool isZero() { return bzero; }
+    bool isZero() { sync(); return bzero; }
 
 
     //
@@ -425,6 +523,12 @@ private:
     // Concludes the current Blitter operation
     void endBlit();
 
+    // Stores the record of the current blit
+    void recordBlit();
+
+    // Adds the record of the current blit to the provided statistics
+    void updateStats(BlitterStats &s);
+
 
     //
     //  Executing the Blitter
@@ -443,11 +547,22 @@ private:
     void beginFastCopyBlit();
 
     // Performs a copy blit operation via the FastBlitter
-    template <bool useA, bool useB, bool useC, bool useD, bool desc>
     void doFastCopyBlit();
+
+    /* Performs a copy blit operation via a copy blit kernel
+     * Common minterms are handled by specialised kernels. All other minterms
+     * are evaluated by a generic kernel (minterm == MINTERM_ANY). Fill mode
+     * is emulated on entire rows via a prefix xor.
+     */
+    void doKernelCopyBlit();
+    template <int minterm, bool desc> void doKernelCopyBlit();
+
+    // Processes a single row inside doKernelCopyBlit()
+    template <int minterm, bool desc> void kernelRow(int w, int ash, int bsh);
     
     // Performs a line blit operation via the FastBlitter
     void doFastLineBlit();
+    template <int octant, bool sing> void doFastLineBlit();
 
 
     //
@@ -475,6 +590,40 @@ private:
     // Emulate the barrel shifter
     void doBarrelShifterA();
     void doBarrelShifterB();
+
+
+    //
+    //  Executing the Parallel Blitter (Called for accuracy levels 0 and 1)
+    //
+
+    /* Hands the current copy blit over to the worker thread
+     * Returns false if the blit is not eligible. In this case, the blit has
+     * to be performed on the emulator thread.
+     */
+    bool runParallel();
+
+    /* Computes the Chip Ram region touched by a DMA channel
+     * The region is returned as a half-open interval of Chip Ram offsets.
+     * Returns false if the region wraps around.
+     */
+    bool footprint(uint32_t pt, int16_t mod, uint32_t &lo, uint32_t &hi);
+
+    // Waits until the worker thread has completed the current blit
+    void finishParallel();
+
+public:
+
+    /* Waits for a blit running on the worker thread
+     * This function has to be called before the effects of the blit become
+     * visible to another component.
+     */
+    void sync() { if (parallelRunning) finishParallel(); }
+
+    /* The thread enter function.
+     * Processes blits until the Blitter is destroyed. It has to be declared
+     * public to make it accessible by the worker thread.
+     */
+    void workerLoop();
 };
 
 #endif
@@ -12,6 +12,38 @@
 Copper::Copper(Amiga& ref) : AmigaComponent(ref)
 {
     setDescription("Copper");
+
+    config.precompute = false;
+
+    memset(&stats, 0, sizeof(stats));
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&lastFrameStats, 0, sizeof(lastFrameStats));
+
+    flushCache();
+}
+
+void
+Copper::_reset()
+{
+    RESET_SNAPSHOT_ITEMS
+
+    discardRun();
+
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&lastFrameStats, 0, sizeof(lastFrameStats));
+}
+
+size_t
+Copper::didLoadFromBuffer(uint8_t *buffer)
+{
+    // Re-arm the guard of a run that was in progress when the snapshot was taken
+    if (runActive) {
+        guardRun();
+    } else {
+        mem.copPending = false;
+    }
+
+    return 0;
 }
 
 void
@@ -29,6 +61,7 @@ Copper::_inspect()
     info.cop2lc  = cop2lc;
     info.length1 = cop1end - cop1lc;
     info.length2 = cop2end - cop2lc;
+    info.frame   = lastFrameStats;
 
     pthread_mutex_unlock(&lock);
 }
@@ -47,6 +80,16 @@ Copper::_dump()
     plainmsg("   cop2lc: %X\n", cop2lc);
     plainmsg("  cop1end: %X\n", cop1end);
     plainmsg("  cop2end: %X\n", cop2end);
+    plainmsg("    cache: %ld hits, %ld misses\n", cacheHits, cacheMisses);
+    plainmsg("  precomp: %s\n", config.precompute ? "yes" : "no");
+    plainmsg("      run: %s\n", runActive ? "active" : "inactive");
+    plainmsg("\nStatistics of the most recently completed frame:\n\n");
+    plainmsg("    moves: %ld\n", lastFrameStats.moves);
+    plainmsg("    waits: %ld\n", lastFrameStats.waits);
+    plainmsg("    skips: %ld\n", lastFrameStats.skips);
+    plainmsg("   in run: %ld\n", lastFrameStats.precomputed);
+    plainmsg("  blocked: %ld\n", lastFrameStats.blocked);
+    plainmsg(" illegals: %ld\n", lastFrameStats.violations);
 }
 
 CopperInfo
@@ -195,6 +238,9 @@ Copper::switchToCopperList(int nr)
 {
     assert(nr == 1 || nr == 2);
 
+    // Stop a precomputed run
+    abortRun();
+
     // debug("switchToCopperList(%d) coppc: %x -> %x\n", nr, coppc, (nr == 1) ? cop1lc : cop2lc);
     coppc = (nr == 1) ? cop1lc : cop2lc;
     copList = nr;
@@ -295,12 +341,15 @@ Copper::findHorizontalMatch(int16_t hStrt, int16_t hComp, int16_t hMask, int16_t
 bool
 Copper::findMatchNew(Beam &match)
 {
-    // Start searching at the current beam position
-    uint32_t beam = (agnus.pos.v << 8) | agnus.pos.h;
+    // Search from the current beam position with the values of the WAIT command
+    return findMatchNew(agnus.pos, getVPHP(), getVMHM(), match);
+}
 
-    // Get the comparison position and the comparison mask
-    uint32_t comp = getVPHP();
-    uint32_t mask = getVMHM();
+bool
+Copper::findMatchNew(Beam start, uint16_t comp, uint16_t mask, Beam &match)
+{
+    // Start searching at the specified beam position
+    uint32_t beam = (start.v << 8) | start.h;
 
     // Iterate through all lines starting from the current position
     while ((beam >> 8) < agnus.frameInfo.numLines) {
@@ -477,9 +526,21 @@ void
 Copper::scheduleWaitWakeup()
 {
     Beam trigger;
+    CopperCacheEntry &ins = lookup(CHIP_PTR(coppc - 4));
+
+    /* Find the trigger position for this WAIT command. The search result only
+     * depends on the start position and the frame length. If both match the
+     * previous search, the cached result is reused.
+     */
+    if (ins.lines != agnus.frameInfo.numLines || ins.from != agnus.pos) {
+        ins.found = findMatchNew(ins.match);
+        ins.from = agnus.pos;
+        ins.lines = agnus.frameInfo.numLines;
+    }
+
+    if (ins.found) {
 
-    // Find the trigger position for this WAIT command
-    if (findMatchNew(trigger)) {
+        trigger = ins.match;
 
         // In how many cycles do we get there?
         int delay = trigger - agnus.pos;
@@ -628,14 +689,50 @@ Copper::isIllegalInstr(uint32_t addr)
     return isMoveCmd(addr) && isIllegalAddress(getRA(addr));
 }
 
+void
+Copper::flushCache()
+{
+    for (int i = 0; i < cacheSize; i++) cache[i].addr = UINT32_MAX;
+}
+
+CopperCacheEntry &
+Copper::lookup(uint32_t addr)
+{
+    CopperCacheEntry &entry = cache[(addr >> 2) & (cacheSize - 1)];
+
+    // Check for a cache hit
+    if (entry.addr == addr && entry.ins1 == cop1ins && entry.ins2 == cop2ins) {
+        cacheHits++;
+        return entry;
+    }
+    cacheMisses++;
+
+    // Decode the instruction
+    entry.addr = addr;
+    entry.ins1 = cop1ins;
+    entry.ins2 = cop2ins;
+    entry.move = isMoveCmd();
+    entry.wait = isWaitCmd();
+    entry.reg = getRA();
+    entry.vphp = getVPHP();
+    entry.vmhm = getVMHM();
+    entry.lines = 0;
+
+    return entry;
+}
+
 void
 Copper::serviceEvent(EventID id)
 {
     uint16_t reg;
     Beam beam;
+    CopperCacheEntry *ins;
 
     servicing = true;
 
+    // A precomputed run ends when the Copper continues with the next command
+    if (runActive) endRun();
+
     switch (id) {
             
         case COP_REQ_DMA:
@@ -648,6 +745,9 @@ Copper::serviceEvent(EventID id)
             // Don't wake up in an odd cycle
             if (agnus.pos.h % 2) { reschedule(); break; }
 
+            // Precompute the upcoming commands if possible
+            if (config.precompute && beginRun(agnus.pos + 2)) break;
+
             // Continue with fetching the first instruction word
             schedule(COP_FETCH);
             break;
@@ -686,11 +786,22 @@ Copper::serviceEvent(EventID id)
             cop2ins = agnus.copperRead(coppc);
             advancePC();
 
+            // Get the decoded instruction
+            ins = &lookup(CHIP_PTR(coppc - 4));
+
             // Extract register number from the first instruction word
-            reg = (cop1ins & 0x1FE);
+            reg = ins->reg;
+
+            // Update statistics
+            frameStats.moves++;
+            frameStats.lines[agnus.pos.v]++;
 
             // Stop the Copper if address is illegal
-            if (isIllegalAddress(reg)) { agnus.cancel<COP_SLOT>(); break; }
+            if (isIllegalAddress(reg)) {
+                frameStats.violations++;
+                agnus.cancel<COP_SLOT>();
+                break;
+            }
 
             // Continue with fetching the new command
             schedule(COP_FETCH);
@@ -724,8 +835,15 @@ Copper::serviceEvent(EventID id)
             cop2ins = agnus.copperRead(coppc);
             advancePC();
 
+            // Get the decoded instruction
+            ins = &lookup(CHIP_PTR(coppc - 4));
+
+            // Update statistics
+            if (ins->wait) frameStats.waits++; else frameStats.skips++;
+            frameStats.lines[agnus.pos.v]++;
+
             // Fork execution depending on the instruction type
-            schedule(isWaitCmd() ? COP_WAIT1 : COP_SKIP1);
+            schedule(ins->wait ? COP_WAIT1 : COP_SKIP1);
             break;
 
         case COP_WAIT1:
@@ -803,7 +921,8 @@ Copper::serviceEvent(EventID id)
 
             // Run the comparator to see if the next command is skipped
             if (verbose) debug("Running comparator with (%d,%d)\n", beam.v, beam.h);
-            skip = comparator(beam);
+            ins = &lookup(CHIP_PTR(coppc - 4));
+            skip = comparator(beam, ins->vphp, ins->vmhm);
 
             // Continue with the next command
             schedule(COP_FETCH);
@@ -848,8 +967,11 @@ Copper::serviceEvent(EventID id)
             if (!agnus.allocateBus<BUS_COPPER>()) { reschedule(); break; }
 
             switchToCopperList(1);
-            schedule(COP_FETCH);
 
+            // Precompute the upcoming commands if possible
+            if (config.precompute && beginRun(agnus.pos + 2)) break;
+
+            schedule(COP_FETCH);
             break;
 
         default:
@@ -883,6 +1005,21 @@ Copper::vsyncHandler()
      *  in COP1LC." [HRM]
      */
 
+    // All color changes of a precomputed run have been handed over
+    discardRun();
+
+    // Finish the statistics of the current frame
+    stats.moves += frameStats.moves;
+    stats.waits += frameStats.waits;
+    stats.skips += frameStats.skips;
+    stats.precomputed += frameStats.precomputed;
+    stats.blocked += frameStats.blocked;
+    stats.violations += frameStats.violations;
+    for (int i = 0; i < COP_LINES; i++) stats.lines[i] += frameStats.lines[i];
+
+    lastFrameStats = frameStats;
+    memset(&frameStats, 0, sizeof(frameStats));
+
     agnus.scheduleRel<COP_SLOT>(DMA_CYCLES(0), COP_VBLANK);
     /*
     if (agnus.doCopDMA()) {
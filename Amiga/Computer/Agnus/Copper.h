@@ -12,10 +12,65 @@
 
 #include "Beam.h"
 
+/* A decoded Copper instruction
+ * The Copper keeps decoded instructions in a direct-mapped cache which is
+ * indexed by the instruction address. Because the Copper has to fetch both
+ * instruction words anyway, an entry is only used if the fetched words match
+ * the cached ones. Hence, modified Copper lists are detected regardless of
+ * which component has written into Chip Ram.
+ */
+typedef struct
+{
+    // Address of the instruction (UINT32_MAX if the entry is empty)
+    uint32_t addr;
+
+    // The instruction words
+    uint16_t ins1;
+    uint16_t ins2;
+
+    // Instruction type
+    bool move;
+    bool wait;
+
+    // MOVE: Target register
+    uint16_t reg;
+
+    // WAIT and SKIP: Comparison position and mask
+    uint16_t vphp;
+    uint16_t vmhm;
+
+    // WAIT: Result of the most recent search for the wake-up position
+    Beam from;
+    int16_t lines;
+    bool found;
+    Beam match;
+}
+CopperCacheEntry;
+
+// A color register change precomputed by the Copper
+typedef struct
+{
+    Beam pos;
+    uint16_t reg;
+    uint16_t value;
+}
+CopperColorChange;
+
+// Fetch position and address of an instruction in a precomputed run
+typedef struct
+{
+    Beam fetch;
+    uint32_t addr;
+}
+CopperStep;
+
 class Copper : public AmigaComponent
 {
     friend class Agnus;
     
+    // The current configuration
+    CopperConfig config;
+
     // Information shown in the GUI inspector panel
     CopperInfo info;
 
@@ -56,6 +111,44 @@ class Copper : public AmigaComponent
     // Storage for disassembled instruction
     char disassembly[128];
 
+    // The instruction cache
+    static const int cacheSize = 1024;
+    CopperCacheEntry cache[cacheSize];
+
+    // Cache statistics (for debugging)
+    long cacheHits = 0;
+    long cacheMisses = 0;
+
+    // Statistics of all completed frames since the last call to clearStats()
+    CopperStats stats;
+
+    // Statistics of the current and the most recently completed frame
+    CopperStats frameStats;
+    CopperStats lastFrameStats;
+
+    /* Precomputed runs
+     * A run is a sequence of MOVE and WAIT commands that only write into
+     * color registers. If precomputation is enabled, the Copper simulates a
+     * run in advance instead of executing it command by command. The
+     * resulting color changes are handed over to Denise line by line.
+     */
+    static const int runCapacity = 2048;
+    static const int runMinMoves = 4;
+
+    // The precomputed color changes (sorted by beam position)
+    CopperColorChange runChanges[runCapacity];
+    int runCount = 0;
+
+    // The next color change to hand over
+    int runNext = 0;
+
+    // Fetch positions of all commands in the run
+    CopperStep runSteps[runCapacity];
+    int runNumSteps = 0;
+
+    // Indicates if a run is in progress
+    bool runActive = false;
+
 public:
 
     // Indicates if Copper is currently servicing an event (for debugging only)
@@ -92,7 +185,20 @@ public:
         & cdang
         & cop1ins
         & cop2ins
-        & coppc;
+        & coppc
+
+        & runCount
+        & runNext
+        & runNumSteps
+        & runActive;
+
+        // Only the used part of the run buffers is serialized
+        for (int i = 0; i < runCount && i < runCapacity; i++) {
+            worker & runChanges[i].pos & runChanges[i].reg & runChanges[i].value;
+        }
+        for (int i = 0; i < runNumSteps && i < runCapacity; i++) {
+            worker & runSteps[i].fetch & runSteps[i].addr;
+        }
     }
 
     
@@ -102,18 +208,37 @@ public:
     
 private:
 
-    void _reset() override { RESET_SNAPSHOT_ITEMS }
+    void _reset() override;
     void _inspect() override; 
     void _dump() override;
     size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
     size_t _load(uint8_t *buffer) override { LOAD_SNAPSHOT_ITEMS }
     size_t _save(uint8_t *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    size_t didLoadFromBuffer(uint8_t *buffer) override;
 
 public:
 
     // Returns the result of the most recent call to inspect()
     CopperInfo getInfo();
 
+    // Returns statistical information about the current activiy
+    CopperStats getStats() { return stats; }
+
+    // Resets the collected statistical information
+    void clearStats() { memset(&stats, 0, sizeof(stats)); }
+
+
+    //
+    // Configuring
+    //
+
+    // Returns the current configuration
+    CopperConfig getConfig() { return config; }
+
+    // Enables or disables the precomputation of color changes
+    bool getPrecompute() { return config.precompute; }
+    void setPrecompute(bool value) { config.precompute = value; }
+
     
     //
     // Accessing properties
@@ -163,6 +288,7 @@ private:
      */
     bool findMatch(Beam &result);
     bool findMatchNew(Beam &result);
+    bool findMatchNew(Beam start, uint16_t comp, uint16_t mask, Beam &result);
 
     // Called by findMatch() to determine the vertical trigger position
     bool findVerticalMatch(int16_t vStrt, int16_t vComp, int16_t vMask, int16_t &result);
@@ -183,6 +309,67 @@ private:
     void scheduleWaitWakeup();
 
 
+    //
+    // Caching decoded instructions
+    //
+
+private:
+
+    // Invalidates all cache entries
+    void flushCache();
+
+    /* Returns the cache entry for the instruction at the specified address
+     * On a cache miss, the instruction in the instruction registers is
+     * decoded. Hence, this function must only be called after both
+     * instruction words have been fetched from that address.
+     */
+    CopperCacheEntry &lookup(uint32_t addr);
+
+
+    //
+    // Precomputing color changes (FastCopper.cpp)
+    //
+
+private:
+
+    /* Tries to precompute a run starting at the current program counter.
+     * Parameter fetch is the position where the first command would be
+     * fetched. Returns false if the commands do not qualify for a run. In
+     * this case, the Copper continues as usual.
+     */
+    bool beginRun(Beam fetch);
+
+    // Returns the next beam position where the Copper can perform DMA
+    Beam dmaCycle(Beam beam) { return beam.h == 0xE0 ? beam + 1 : beam; }
+
+    // Guards the Copper list region covered by the active run
+    void guardRun();
+
+    // Stops guarding the run (remaining color changes are still handed over)
+    void endRun();
+
+    // Discards the run including all color changes that have not been handed over
+    void discardRun();
+
+public:
+
+    // Indicates if a run is in progress
+    bool hasActiveRun() { return runActive; }
+
+    // Indicates if bitplane DMA occupies even DMA cycles (no runs possible)
+    static bool bplDmaBlocksCopper(uint16_t bplcon0);
+
+    /* Aborts the run at the current beam position. All color changes of
+     * commands that have not been fetched yet are discarded and the Copper
+     * continues at the first of these commands. This function is called when
+     * the Copper list is modified while the run is in progress.
+     */
+    void abortRun();
+
+    // Hands over the precomputed color changes of a rasterline to Denise
+    void deliverRun(int16_t line);
+
+
     //
     // Analyzing Copper instructions
     //
@@ -9,30 +9,26 @@
 
 #include "Amiga.h"
 
+#if defined(__SSE2__)
+#include <x86intrin.h>
+#endif
+
 void
 Blitter::initFastBlitter()
 {
-    void (Blitter::*blitfunc[32])(void) = {
-        &Blitter::doFastCopyBlit<0,0,0,0,0>, &Blitter::doFastCopyBlit<0,0,0,0,1>,
-        &Blitter::doFastCopyBlit<0,0,0,1,0>, &Blitter::doFastCopyBlit<0,0,0,1,1>,
-        &Blitter::doFastCopyBlit<0,0,1,0,0>, &Blitter::doFastCopyBlit<0,0,1,0,1>,
-        &Blitter::doFastCopyBlit<0,0,1,1,0>, &Blitter::doFastCopyBlit<0,0,1,1,1>,
-        &Blitter::doFastCopyBlit<0,1,0,0,0>, &Blitter::doFastCopyBlit<0,1,0,0,1>,
-        &Blitter::doFastCopyBlit<0,1,0,1,0>, &Blitter::doFastCopyBlit<0,1,0,1,1>,
-        &Blitter::doFastCopyBlit<0,1,1,0,0>, &Blitter::doFastCopyBlit<0,1,1,0,1>,
-        &Blitter::doFastCopyBlit<0,1,1,1,0>, &Blitter::doFastCopyBlit<0,1,1,1,1>,
-        &Blitter::doFastCopyBlit<1,0,0,0,0>, &Blitter::doFastCopyBlit<1,0,0,0,1>,
-        &Blitter::doFastCopyBlit<1,0,0,1,0>, &Blitter::doFastCopyBlit<1,0,0,1,1>,
-        &Blitter::doFastCopyBlit<1,0,1,0,0>, &Blitter::doFastCopyBlit<1,0,1,0,1>,
-        &Blitter::doFastCopyBlit<1,0,1,1,0>, &Blitter::doFastCopyBlit<1,0,1,1,1>,
-        &Blitter::doFastCopyBlit<1,1,0,0,0>, &Blitter::doFastCopyBlit<1,1,0,0,1>,
-        &Blitter::doFastCopyBlit<1,1,0,1,0>, &Blitter::doFastCopyBlit<1,1,0,1,1>,
-        &Blitter::doFastCopyBlit<1,1,1,0,0>, &Blitter::doFastCopyBlit<1,1,1,0,1>,
-        &Blitter::doFastCopyBlit<1,1,1,1,0>, &Blitter::doFastCopyBlit<1,1,1,1,1>
+    void (Blitter::*linefunc[16])(void) = {
+        &Blitter::doFastLineBlit<0,0>, &Blitter::doFastLineBlit<0,1>,
+        &Blitter::doFastLineBlit<1,0>, &Blitter::doFastLineBlit<1,1>,
+        &Blitter::doFastLineBlit<2,0>, &Blitter::doFastLineBlit<2,1>,
+        &Blitter::doFastLineBlit<3,0>, &Blitter::doFastLineBlit<3,1>,
+        &Blitter::doFastLineBlit<4,0>, &Blitter::doFastLineBlit<4,1>,
+        &Blitter::doFastLineBlit<5,0>, &Blitter::doFastLineBlit<5,1>,
+        &Blitter::doFastLineBlit<6,0>, &Blitter::doFastLineBlit<6,1>,
+        &Blitter::doFastLineBlit<7,0>, &Blitter::doFastLineBlit<7,1>
     };
 
-    assert(sizeof(this->blitfunc) == sizeof(blitfunc));
-    memcpy(this->blitfunc, blitfunc, sizeof(blitfunc));
+    assert(sizeof(this->linefunc) == sizeof(linefunc));
+    memcpy(this->linefunc, linefunc, sizeof(linefunc));
 }
 
 void
@@ -55,133 +51,450 @@ Blitter::beginFastCopyBlit()
     // Only call this function in copy blit mode
     assert(!bltconLINE());
 
-    // Run the fast copy Bliter
-    int nr = ((bltcon0 >> 7) & 0b11110) | !!bltconDESC();
-    (this->*blitfunc[nr])();
+    // Run the fast copy Bliter (on the worker thread if possible)
+    if (!runParallel()) doFastCopyBlit();
 
     // Terminate immediately
     signalEnd();
     endBlit();
 }
 
-template <bool useA, bool useB, bool useC, bool useD, bool desc>
-void Blitter::doFastCopyBlit()
+void
+Blitter::doFastCopyBlit()
 {
-    uint32_t apt = bltapt;
-    uint32_t bpt = bltbpt;
-    uint32_t cpt = bltcpt;
-    uint32_t dpt = bltdpt;
+    doKernelCopyBlit();
+}
 
-    bool fill = bltconFE();
-    bool fillCarry;
+//
+// Copy blit kernels
+//
 
-    int incr = desc ? -2 : 2;
-    int ash = desc ? 16 - bltconASH() : bltconASH();
-    int bsh = desc ? 16 - bltconBSH() : bltconBSH();
+// Template argument selecting the generic kernel
+static const int MINTERM_ANY = 0x100;
+
+/* Evaluates a minterm on a single word or on a SIMD register. Common minterms
+ * are hard-wired. All others are evaluated as a sum of products, broken down
+ * into seven multiplexers via Shannon expansion. lanes[i] is either all ones
+ * or all zeroes, depending on bit i of the minterm.
+ */
+template <int minterm, class T> static inline T
+kernelMinterm(T a, T b, T c, const T *lanes)
+{
+    switch (minterm) {
+
+        case 0x00: return T(a ^ a);              // Clear
+        case 0xFF: return T(~(a ^ a));           // Set
+        case 0xF0: return a;                     // Copy A
+        case 0xCC: return b;                     // Copy B
+        case 0x0F: return T(~a);                 // Copy inverted A
+        case 0xCA: return T((a & b) | (~a & c)); // Cookie cut (mask in A)
+        case 0xE2: return T((b & a) | (~b & c)); // Cookie cut (mask in B)
+        case 0x5A: return T(a ^ c);              // A xor C
+        case 0x3C: return T(a ^ b);              // A xor B
+
+        default:
+        {
+            // Upper case: Input is set, lower case: Input is cleared
+            T AB = T(lanes[6] ^ ((lanes[7] ^ lanes[6]) & c));
+            T Ab = T(lanes[4] ^ ((lanes[5] ^ lanes[4]) & c));
+            T aB = T(lanes[2] ^ ((lanes[3] ^ lanes[2]) & c));
+            T ab = T(lanes[0] ^ ((lanes[1] ^ lanes[0]) & c));
+            T a1 = T(Ab ^ ((AB ^ Ab) & b));
+            T a0 = T(ab ^ ((aB ^ ab) & b));
+            return T(a0 ^ ((a1 ^ a0) & a));
+        }
+    }
+}
+
+/* Emulates the barrel shifter. 'prev' is the previously fetched word and
+ * 'shift' the value of the ASH or BSH bits.
+ */
+template <bool desc> static inline uint16_t
+kernelShift(uint16_t prev, uint16_t word, int shift)
+{
+    if (desc) {
+        return (uint16_t)((word << shift) | (prev >> (16 - shift)));
+    } else {
+        return (uint16_t)((word >> shift) | (prev << (16 - shift)));
+    }
+}
+
+#if !defined(__SSE2__)
+
+// Counterpart of kernelShift() operating on four words at once
+template <bool desc> static inline uint64_t
+kernelShift64(uint64_t prev, uint64_t word, int shift)
+{
+    const uint64_t rep = 0x0001000100010001ULL;
+
+    if (desc) {
+        uint64_t hi = (uint64_t)((0xFFFF << shift) & 0xFFFF) * rep;
+        uint64_t lo = (uint64_t)(0xFFFF >> (16 - shift)) * rep;
+        return ((word << shift) & hi) | ((prev >> (16 - shift)) & lo);
+    } else {
+        uint64_t lo = (uint64_t)(0xFFFF >> shift) * rep;
+        uint64_t hi = (uint64_t)((0xFFFF << (16 - shift)) & 0xFFFF) * rep;
+        return ((word >> shift) & lo) | ((prev << (16 - shift)) & hi);
+    }
+}
+
+#endif
+
+/* Computes the prefix xor of a word. Bit k of the result is the parity of
+ * bits 0 to k of the input.
+ */
+static inline uint16_t
+kernelPrefixXor(uint16_t x)
+{
+    x ^= (uint16_t)(x << 1);
+    x ^= (uint16_t)(x << 2);
+    x ^= (uint16_t)(x << 4);
+    x ^= (uint16_t)(x << 8);
+    return x;
+}
+
+// Counterpart of kernelPrefixXor() operating on four words at once
+static inline uint64_t
+kernelPrefixXor64(uint64_t x)
+{
+#if defined(__PCLMUL__) && defined(__x86_64__)
+
+    // A carry-less multiplication with all ones computes all prefixes at once
+    __m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)x),
+                                     _mm_set1_epi64x(-1), 0);
+    return (uint64_t)_mm_cvtsi128_si64(p);
+
+#else
+
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+
+#endif
+}
+
+/* Emulates the fill logic on a row of words in processing order. The fill
+ * carry toggles at each set bit, starting with bit 0 of the first word. Hence,
+ * the carry entering a bit equals the initial carry xor the parity of all
+ * preceding bits, which is a shifted prefix xor. Inclusive fill ors the carry
+ * into the data, exclusive fill xors it. Returns true if any result bit is set.
+ */
+static inline bool
+kernelFill(uint16_t *row, int w, bool exclusive, bool &carry)
+{
+    int x = 0;
+    uint64_t acc = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+    // Four consecutive words form a single 64 bit stream in processing order
+    for (; x + 4 <= w; x += 4) {
+
+        uint64_t d;
+        memcpy(&d, row + x, 8);
+
+        uint64_t p = kernelPrefixXor64(d);
+        uint64_t cin = (p << 1) ^ (carry ? ~0ULL : 0);
+        carry = carry != (bool)(p >> 63);
+
+        d = exclusive ? d ^ cin : d | cin;
+        memcpy(row + x, &d, 8);
+        acc |= d;
+    }
+
+#endif
+
+    for (; x < w; x++) {
+
+        uint16_t p = kernelPrefixXor(row[x]);
+        uint16_t cin = (uint16_t)((p << 1) ^ (carry ? 0xFFFF : 0));
+        carry = carry != (bool)(p >> 15);
+
+        row[x] = exclusive ? row[x] ^ cin : row[x] | cin;
+        acc |= row[x];
+    }
+
+    return acc != 0;
+}
+
+void
+Blitter::doKernelCopyBlit()
+{
+    bool desc = bltconDESC();
+
+    switch (bltcon0 & 0xFF) {
+
+        case 0x00: desc ? doKernelCopyBlit<0x00,1>() : doKernelCopyBlit<0x00,0>(); break;
+        case 0xFF: desc ? doKernelCopyBlit<0xFF,1>() : doKernelCopyBlit<0xFF,0>(); break;
+        case 0xF0: desc ? doKernelCopyBlit<0xF0,1>() : doKernelCopyBlit<0xF0,0>(); break;
+        case 0xCC: desc ? doKernelCopyBlit<0xCC,1>() : doKernelCopyBlit<0xCC,0>(); break;
+        case 0x0F: desc ? doKernelCopyBlit<0x0F,1>() : doKernelCopyBlit<0x0F,0>(); break;
+        case 0xCA: desc ? doKernelCopyBlit<0xCA,1>() : doKernelCopyBlit<0xCA,0>(); break;
+        case 0xE2: desc ? doKernelCopyBlit<0xE2,1>() : doKernelCopyBlit<0xE2,0>(); break;
+        case 0x5A: desc ? doKernelCopyBlit<0x5A,1>() : doKernelCopyBlit<0x5A,0>(); break;
+        case 0x3C: desc ? doKernelCopyBlit<0x3C,1>() : doKernelCopyBlit<0x3C,0>(); break;
+
+        default:
+            desc ? doKernelCopyBlit<MINTERM_ANY,1>() : doKernelCopyBlit<MINTERM_ANY,0>();
+            break;
+    }
+}
+
+template <int minterm, bool desc> void
+Blitter::doKernelCopyBlit()
+{
     int32_t amod = desc ? -bltamod : bltamod;
     int32_t bmod = desc ? -bltbmod : bltbmod;
     int32_t cmod = desc ? -bltcmod : bltcmod;
     int32_t dmod = desc ? -bltdmod : bltdmod;
 
-    aold = 0;
-    bold = 0;
+    // Reset the barrel shifter inputs
+    rowA[0] = 0;
+    rowB[0] = 0;
 
     for (int y = 0; y < bltsizeH; y++) {
 
-        // Reset the fill carry bit
-        fillCarry = !!bltconFCI();
+        kernelRow<minterm, desc>(bltsizeW, bltconASH(), bltconBSH());
 
-        // Apply the "first word mask" in the first iteration
-        uint16_t mask = bltafwm;
+        // Add modulo values
+        if (bltconUSEA()) INC_CHIP_PTR_BY(bltapt, amod);
+        if (bltconUSEB()) INC_CHIP_PTR_BY(bltbpt, bmod);
+        if (bltconUSEC()) INC_CHIP_PTR_BY(bltcpt, cmod);
+        if (bltconUSED()) INC_CHIP_PTR_BY(bltdpt, dmod);
+    }
+}
 
-        for (int x = 0; x < bltsizeW; x++) {
+template <int minterm, bool desc> void
+Blitter::kernelRow(int w, int ash, int bsh)
+{
+    bool useA = bltconUSEA();
+    bool useB = bltconUSEB();
+    bool useC = bltconUSEC();
+    bool useD = bltconUSED();
 
-            // Apply the "last word mask" in the last iteration
-            if (x == bltsizeW - 1) mask &= bltalwm;
+    uint8_t *chip = mem.chip;
+    uint32_t chipMask = mem.chipMask;
+    int incr = desc ? -2 : 2;
+    uint16_t any = 0;
 
-            // Fetch A
-            if (useA) {
-                anew = mem.peek16<BUS_BLITTER>(apt);
-                debug(BLT_DEBUG, "    A = peek(%X) = %X\n", apt, anew);
-                INC_CHIP_PTR_BY(apt, incr);
-            }
+    bool fill = bltconFE();
+    bool exclusive = bltconEFE();
+    bool fillCarry = bltconFCI();
+
+    // Translate the minterm into lane masks for the generic kernel
+    uint16_t lanes[8];
+    for (int i = 0; i < 8; i++) lanes[i] = GET_BIT(bltcon0, i) ? 0xFFFF : 0;
+
+    /* The kernel fetches the whole row before writing it back. This is only
+     * correct if no D word overwrites a source word of the same row that is
+     * fetched later. Such rows are processed word by word.
+     */
+    auto overlaps = [&](uint32_t src) {
+        uint32_t diff = (desc ? src - bltdpt : bltdpt - src) & chipMask;
+        return diff >= 2 && diff <= 2 * (uint32_t)(w - 1);
+    };
+    bool hazard = useD &&
+    ((useA && overlaps(bltapt)) || (useB && overlaps(bltbpt)) || (useC && overlaps(bltcpt)));
+
+    if (hazard) {
+
+        for (int x = 1; x <= w; x++) {
+
+            if (useA) { anew = READ_16(chip + (bltapt & chipMask)); INC_CHIP_PTR_BY(bltapt, incr); }
+            if (useB) { bnew = READ_16(chip + (bltbpt & chipMask)); INC_CHIP_PTR_BY(bltbpt, incr); }
+            if (useC) { chold = READ_16(chip + (bltcpt & chipMask)); INC_CHIP_PTR_BY(bltcpt, incr); }
+
+            uint16_t mask = 0xFFFF;
+            if (x == 1) mask &= bltafwm;
+            if (x == w) mask &= bltalwm;
 
-            // Fetch B
-            if (useB) {
-                bnew = mem.peek16<BUS_BLITTER>(bpt);
-                debug(BLT_DEBUG, "    B = peek(%X) = %X\n", bpt, bnew);
-                INC_CHIP_PTR_BY(bpt, incr);
+            rowA[x] = anew & mask;
+            rowB[x] = bnew;
+            rowC[x] = chold;
+            rowD[x] = kernelMinterm<minterm>(kernelShift<desc>(rowA[x - 1], rowA[x], ash),
+                                             kernelShift<desc>(rowB[x - 1], rowB[x], bsh),
+                                             rowC[x], lanes);
+            if (fill) kernelFill(rowD + x, 1, exclusive, fillCarry);
+            any |= rowD[x];
+
+            if (useD) {
+                if (!inWorker) mem.markChipDirty(bltdpt, 2);
+                WRITE_16(chip + (bltdpt & chipMask), rowD[x]);
+                check1 = fnv_1a_it32(check1, rowD[x]);
+                check2 = fnv_1a_it32(check2, bltdpt);
+                INC_CHIP_PTR_BY(bltdpt, incr);
             }
+        }
 
-            // Fetch C
-            if (useC) {
-                chold = mem.peek16<BUS_BLITTER>(cpt);
-                debug(BLT_DEBUG, "    C = peek(%X) = %X\n", cpt, chold);
-                INC_CHIP_PTR_BY(cpt, incr);
+    } else {
+
+        // Fetch the source words (unused channels deliver the data registers)
+        if (useA) {
+            for (int x = 1; x <= w; x++) {
+                rowA[x] = READ_16(chip + (bltapt & chipMask));
+                INC_CHIP_PTR_BY(bltapt, incr);
+            }
+            anew = rowA[w];
+        } else {
+            for (int x = 1; x <= w; x++) rowA[x] = anew;
+        }
+        if (useB) {
+            for (int x = 1; x <= w; x++) {
+                rowB[x] = READ_16(chip + (bltbpt & chipMask));
+                INC_CHIP_PTR_BY(bltbpt, incr);
+            }
+            bnew = rowB[w];
+        } else {
+            for (int x = 1; x <= w; x++) rowB[x] = bnew;
+        }
+        if (useC) {
+            for (int x = 1; x <= w; x++) {
+                rowC[x] = READ_16(chip + (bltcpt & chipMask));
+                INC_CHIP_PTR_BY(bltcpt, incr);
             }
-            debug(BLT_DEBUG, "    After fetch: A = %x B = %x C = %x\n", anew, bnew, chold);
+            chold = rowC[w];
+        } else {
+            for (int x = 1; x <= w; x++) rowC[x] = chold;
+        }
+
+        // Apply the first and the last word mask
+        rowA[1] &= bltafwm;
+        rowA[w] &= bltalwm;
+
+        // Run the barrel shifters and the minterm logic
+        int x = 1;
+
+#if defined(__AVX2__)
+
+        // Process sixteen words at a time
+        __m256i lanes256[8];
+        for (int i = 0; i < 8; i++) lanes256[i] = _mm256_set1_epi16(lanes[i]);
+
+        __m128i sa = _mm_cvtsi32_si128(ash), sa2 = _mm_cvtsi32_si128(16 - ash);
+        __m128i sb = _mm_cvtsi32_si128(bsh), sb2 = _mm_cvtsi32_si128(16 - bsh);
+        __m256i acc = _mm256_setzero_si256();
+
+        for (; x + 16 <= w + 1; x += 16) {
 
-            debug(BLT_DEBUG, "    After masking with %x (%x,%x) %x\n", mask, bltafwm, bltalwm, anew & mask);
+            __m256i a = _mm256_loadu_si256((__m256i *)(rowA + x));
+            __m256i ap = _mm256_loadu_si256((__m256i *)(rowA + x - 1));
+            __m256i b = _mm256_loadu_si256((__m256i *)(rowB + x));
+            __m256i bp = _mm256_loadu_si256((__m256i *)(rowB + x - 1));
+            __m256i c = _mm256_loadu_si256((__m256i *)(rowC + x));
 
-            // Run the barrel shifters on data path A and B
-            debug(BLT_DEBUG, "    ash = %d bsh = %d mask = %X\n", bltconASH(), bltconBSH(), mask);
             if (desc) {
-                ahold = HI_W_LO_W(anew & mask, aold) >> ash;
-                bhold = HI_W_LO_W(bnew, bold) >> bsh;
+                a = _mm256_or_si256(_mm256_sll_epi16(a, sa), _mm256_srl_epi16(ap, sa2));
+                b = _mm256_or_si256(_mm256_sll_epi16(b, sb), _mm256_srl_epi16(bp, sb2));
             } else {
-                ahold = HI_W_LO_W(aold, anew & mask) >> ash;
-                bhold = HI_W_LO_W(bold, bnew) >> bsh;
+                a = _mm256_or_si256(_mm256_srl_epi16(a, sa), _mm256_sll_epi16(ap, sa2));
+                b = _mm256_or_si256(_mm256_srl_epi16(b, sb), _mm256_sll_epi16(bp, sb2));
             }
-            aold = anew & mask;
-            bold = bnew;
-            debug(BLT_DEBUG, "    After shifting (%d,%d) A = %x B = %x\n", ash, bsh, ahold, bhold);
 
-            // Run the minterm logic circuit
-            debug(BLT_DEBUG, "    Minterms: ahold = %X bhold = %X chold = %X bltcon0 = %X (hex)\n", ahold, bhold, chold, bltcon0);
-            dhold = doMintermLogicQuick(ahold, bhold, chold, bltcon0 & 0xFF);
-            assert(dhold == doMintermLogic(ahold, bhold, chold, bltcon0 & 0xFF));
+            __m256i d = kernelMinterm<minterm>(a, b, c, lanes256);
+            _mm256_storeu_si256((__m256i *)(rowD + x), d);
+            acc = _mm256_or_si256(acc, d);
+        }
+        if (!_mm256_testz_si256(acc, acc)) any = 1;
 
-            // Run the fill logic circuit
-            if (fill) doFill(dhold, fillCarry);
+#elif defined(__SSE2__)
 
-            // Update the zero flag
-            if (dhold) bzero = false;
+        // Process eight words at a time
+        __m128i lanes128[8];
+        for (int i = 0; i < 8; i++) lanes128[i] = _mm_set1_epi16(lanes[i]);
 
-            // Write D
-            if (useD) {
-                mem.poke16<BUS_BLITTER>(dpt, dhold);
-                check1 = fnv_1a_it32(check1, dhold);
-                check2 = fnv_1a_it32(check2, dpt);
-                debug(BLT_DEBUG, "D: poke(%X), %X  (check: %X %X)\n", dpt, dhold, check1, check2);
-                // plainmsg("    check1 = %X check2 = %X\n", check1, check2);
+        __m128i sa = _mm_cvtsi32_si128(ash), sa2 = _mm_cvtsi32_si128(16 - ash);
+        __m128i sb = _mm_cvtsi32_si128(bsh), sb2 = _mm_cvtsi32_si128(16 - bsh);
+        __m128i acc = _mm_setzero_si128();
+
+        for (; x + 8 <= w + 1; x += 8) {
 
-                INC_CHIP_PTR_BY(dpt, incr);
+            __m128i a = _mm_loadu_si128((__m128i *)(rowA + x));
+            __m128i ap = _mm_loadu_si128((__m128i *)(rowA + x - 1));
+            __m128i b = _mm_loadu_si128((__m128i *)(rowB + x));
+            __m128i bp = _mm_loadu_si128((__m128i *)(rowB + x - 1));
+            __m128i c = _mm_loadu_si128((__m128i *)(rowC + x));
+
+            if (desc) {
+                a = _mm_or_si128(_mm_sll_epi16(a, sa), _mm_srl_epi16(ap, sa2));
+                b = _mm_or_si128(_mm_sll_epi16(b, sb), _mm_srl_epi16(bp, sb2));
+            } else {
+                a = _mm_or_si128(_mm_srl_epi16(a, sa), _mm_sll_epi16(ap, sa2));
+                b = _mm_or_si128(_mm_srl_epi16(b, sb), _mm_sll_epi16(bp, sb2));
             }
 
-            // Clear the word mask
-            mask = 0xFFFF;
+            __m128i d = kernelMinterm<minterm>(a, b, c, lanes128);
+            _mm_storeu_si128((__m128i *)(rowD + x), d);
+            acc = _mm_or_si128(acc, d);
         }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF) any = 1;
 
-        // Add modulo values
-        if (useA) INC_CHIP_PTR_BY(apt, amod);
-        if (useB) INC_CHIP_PTR_BY(bpt, bmod);
-        if (useC) INC_CHIP_PTR_BY(cpt, cmod);
-        if (useD) INC_CHIP_PTR_BY(dpt, dmod);
+#else
+
+        // Process four words at a time
+        uint64_t lanes64[8];
+        for (int i = 0; i < 8; i++) lanes64[i] = lanes[i] * 0x0001000100010001ULL;
+
+        uint64_t acc = 0;
+
+        for (; x + 4 <= w + 1; x += 4) {
+
+            uint64_t a, ap, b, bp, c, d;
+            memcpy(&a, rowA + x, 8);
+            memcpy(&ap, rowA + x - 1, 8);
+            memcpy(&b, rowB + x, 8);
+            memcpy(&bp, rowB + x - 1, 8);
+            memcpy(&c, rowC + x, 8);
+
+            d = kernelMinterm<minterm>(kernelShift64<desc>(ap, a, ash),
+                                       kernelShift64<desc>(bp, b, bsh),
+                                       c, lanes64);
+            memcpy(rowD + x, &d, 8);
+            acc |= d;
+        }
+        if (acc) any = 1;
+
+#endif
+
+        for (; x <= w; x++) {
+            rowD[x] = kernelMinterm<minterm>(kernelShift<desc>(rowA[x - 1], rowA[x], ash),
+                                             kernelShift<desc>(rowB[x - 1], rowB[x], bsh),
+                                             rowC[x], lanes);
+            any |= rowD[x];
+        }
+
+        // Run the fill logic on the whole row
+        if (fill) any = kernelFill(rowD + 1, w, exclusive, fillCarry);
+
+        // Write back the result
+        if (useD) {
+            for (int x = 1; x <= w; x++) {
+                if (!inWorker) mem.markChipDirty(bltdpt, 2);
+                WRITE_16(chip + (bltdpt & chipMask), rowD[x]);
+                check1 = fnv_1a_it32(check1, rowD[x]);
+                check2 = fnv_1a_it32(check2, bltdpt);
+                INC_CHIP_PTR_BY(bltdpt, incr);
+            }
+        }
     }
 
-    // Do some consistency checks
-    /*
-    assert(apt == useA ? bltapt + (incr * bltsizeW + amod) * bltsizeH : bltapt);
-    assert(bpt == useB ? bltbpt + (incr * bltsizeW + bmod) * bltsizeH : bltbpt);
-    assert(cpt == useC ? bltcpt + (incr * bltsizeW + cmod) * bltsizeH : bltcpt);
-    assert(dpt == useD ? bltdpt + (incr * bltsizeW + dmod) * bltsizeH : bltdpt);
-    */
-
-    // Write back pointer registers
-    bltapt = apt;
-    bltbpt = bpt;
-    bltcpt = cpt;
-    bltdpt = dpt;
+    // Update the zero flag
+    if (any) bzero = false;
+
+    // Update the pipeline registers as if the row had been processed word by word
+    aold = rowA[w];
+    bold = rowB[w];
+    ahold = kernelShift<desc>(rowA[w - 1], rowA[w], ash);
+    bhold = kernelShift<desc>(rowB[w - 1], rowB[w], bsh);
+    dhold = rowD[w];
+    if ((useA || useB || useC) && !inWorker) mem.dataBus = useC ? chold : useB ? bnew : anew;
+
+    // Feed the barrel shifters of the next row
+    rowA[0] = rowA[w];
+    rowB[0] = rowB[w];
 }
 
 #define blitterLineIncreaseX(a_shift, cpt) \
@@ -210,144 +523,115 @@ INC_CHIP_PTR_BY(cpt, -cmod);
 
 void
 Blitter::doFastLineBlit()
+{
+    // Select the line engine for the current octant and the SING bit
+    int nr = (bltcon1 >> 1) & 0xF;
+    (this->*linefunc[nr])();
+}
+
+template <int octant, bool sing>
+void Blitter::doFastLineBlit()
 {
     //
     // Adapted from WinFellow
     //
 
-    uint32_t bltcon = HI_W_LO_W(bltcon0, bltcon1);
-    
-    int height = bltsizeH;
-    
-    uint16_t bltadat_local = 0;
-    uint16_t bltbdat_local = 0;
-    uint16_t bltcdat_local = chold;
-    uint16_t bltddat_local = 0;
-    
-    uint16_t mask = (bnew >> bltconBSH()) | (bnew << (16 - bltconBSH()));
-    bool a_enabled = bltcon & 0x08000000;
-    bool c_enabled = bltcon & 0x02000000;
-    
-    bool decision_is_signed = (((bltcon >> 6) & 1) == 1);
-    uint32_t decision_variable = bltapt;
-    
+    // Decode the octant (SUD, SUL, AUL)
+    const bool xIndependent = octant & 4;
+    const bool xInc = xIndependent ? !(octant & 1) : !(octant & 2);
+    const bool yInc = xIndependent ? !(octant & 2) : !(octant & 1);
+
+    // Single-bit mode only affects lines that step in the y direction
+    const bool singleBit = sing && xIndependent;
+
+    bool useA = bltconUSEA();
+    bool useC = bltconUSEC();
+
+    uint8_t *chip = mem.chip;
+    uint32_t chipMask = mem.chipMask;
+
+    // Translate the minterm into lane masks for the generic minterm kernel
+    uint16_t lanes[8];
+    for (int i = 0; i < 8; i++) lanes[i] = GET_BIT(bltcon0, i) ? 0xFFFF : 0;
+
+    uint16_t adat = anew & bltafwm;
+    uint16_t bdat = 0;
+    uint16_t cdat = chold;
+    uint16_t ddat;
+    uint16_t any = 0;
+    uint16_t pattern = (uint16_t)((bnew >> bltconBSH()) | (bnew << (16 - bltconBSH())));
+
     // Quirk: Set decision increases to 0 if a is disabled, ensures bltapt remains unchanged
-    int16_t decision_inc_signed = a_enabled ? bltbmod : 0;
-    int16_t decision_inc_unsigned = a_enabled ? bltamod : 0;
-    
-    uint32_t bltcpt_local = bltcpt;
-    uint32_t bltdpt_local = bltdpt;
-    uint32_t blit_a_shift_local = bltconASH();
-    uint32_t bltzero_local = 0;
-    uint32_t i;
-    
-    uint32_t sulsudaul = (bltcon >> 2) & 0x7;
-    bool x_independent = (sulsudaul & 4);
-    bool x_inc = ((!x_independent) && !(sulsudaul & 2)) || (x_independent && !(sulsudaul & 1));
-    bool y_inc = ((!x_independent) && !(sulsudaul & 1)) || (x_independent && !(sulsudaul & 2));
-    bool single_dot = false;
-    uint8_t minterm = (uint8_t)(bltcon >> 16);
-    
-    for (i = 0; i < height; ++i)
-    {
+    bool sign = GET_BIT(bltcon1, 6);
+    uint32_t decision = bltapt;
+    int16_t incSigned = useA ? bltbmod : 0;
+    int16_t incUnsigned = useA ? bltamod : 0;
+
+    uint32_t cpt = bltcpt;
+    uint32_t dpt = bltdpt;
+    uint32_t ash = bltconASH();
+    bool dotDrawn = false;
+
+    for (int i = 0; i < bltsizeH; i++) {
+
         // Read C-data from memory if the C-channel is enabled
-        if (c_enabled) {
-            bltcdat_local = mem.peek16<BUS_BLITTER>(bltcpt_local);
-        }
-        
-        // Calculate data for the A-channel
-        bltadat_local = (anew & bltafwm) >> blit_a_shift_local;
-        
-        // Check for single dot
-        if (x_independent) {
-            if (bltcon & 0x00000002) {
-                if (single_dot) {
-                    bltadat_local = 0;
-                } else {
-                    single_dot = TRUE;
-                }
-            }
+        if (useC) cdat = READ_16(chip + (cpt & chipMask));
+
+        // Calculate data for the A-channel and the B-channel
+        uint16_t a = adat >> ash;
+        if (singleBit) {
+            if (dotDrawn) a = 0; else dotDrawn = true;
         }
-        
-        // Calculate data for the B-channel
-        bltbdat_local = (mask & 1) ? 0xFFFF : 0;
-        
+        bdat = (pattern & 1) ? 0xFFFF : 0;
+
         // Calculate result
-        bltddat_local = doMintermLogicQuick(bltadat_local, bltbdat_local, bltcdat_local, minterm);
-        
-        // Save result to D-channel, same as the C ptr after first pixel.
-        if (c_enabled) { // C-channel must be enabled
-            mem.poke16<BUS_BLITTER>(bltdpt_local, bltddat_local);
-            check1 = fnv_1a_it32(check1, bltddat_local);
-            check2 = fnv_1a_it32(check2, bltdpt_local);
+        ddat = kernelMinterm<MINTERM_ANY>(a, bdat, cdat, lanes);
+        any |= ddat;
+
+        // Save result to D-channel, same as the C ptr after first pixel
+        if (useC) {
+            mem.markChipDirty(dpt, 2);
+            WRITE_16(chip + (dpt & chipMask), ddat);
+            check1 = fnv_1a_it32(check1, ddat);
+            check2 = fnv_1a_it32(check2, dpt);
         }
-        
-        // Remember zero result status
-        bltzero_local = bltzero_local | bltddat_local;
-        
-        // Rotate mask
-        mask = (mask << 1) | (mask >> 15);
-        
-        // Test movement in the X direction
-        // When the decision variable gets positive,
-        // the line moves one pixel to the right
-        
-        // decrease/increase x
-        if (decision_is_signed) {
-            // Do not yet increase, D has sign
-            // D = D + (2*sdelta = bltbmod)
-            decision_variable += decision_inc_signed;
+
+        // Rotate the line pattern
+        pattern = (uint16_t)((pattern << 1) | (pattern >> 15));
+
+        // Step in the minor direction if the decision variable is positive
+        if (sign) {
+            decision += incSigned;
         } else {
-            // increase, D reached a positive value
-            // D = D + (2*sdelta - 2*ldelta = bltamod)
-            decision_variable += decision_inc_unsigned;
-            
-            if (!x_independent) {
-                if (x_inc) {
-                    blitterLineIncreaseX(blit_a_shift_local, bltcpt_local);
-                } else {
-                    blitterLineDecreaseX(blit_a_shift_local, bltcpt_local);
-                }
-            } else {
-                if (y_inc) {
-                    blitterLineIncreaseY(bltcpt_local, bltcmod);
-                } else {
-                    blitterLineDecreaseY(bltcpt_local, bltcmod);
-                }
-                single_dot = false;
-            }
-        }
-        decision_is_signed = ((int16_t)decision_variable < 0);
-        
-        if (!x_independent)
-        {
-            // decrease/increase y
-            if (y_inc) {
-                blitterLineIncreaseY(bltcpt_local, bltcmod);
+            decision += incUnsigned;
+            if (!xIndependent) {
+                if (xInc) { blitterLineIncreaseX(ash, cpt); } else { blitterLineDecreaseX(ash, cpt); }
             } else {
-                blitterLineDecreaseY(bltcpt_local, bltcmod);
+                if (yInc) { blitterLineIncreaseY(cpt, bltcmod); } else { blitterLineDecreaseY(cpt, bltcmod); }
+                dotDrawn = false;
             }
         }
-        else
-        {
-            if (x_inc) {
-                blitterLineIncreaseX(blit_a_shift_local, bltcpt_local);
-            } else {
-                blitterLineDecreaseX(blit_a_shift_local, bltcpt_local);
-            }
+        sign = (int16_t)decision < 0;
+
+        // Step in the major direction
+        if (!xIndependent) {
+            if (yInc) { blitterLineIncreaseY(cpt, bltcmod); } else { blitterLineDecreaseY(cpt, bltcmod); }
+        } else {
+            if (xInc) { blitterLineIncreaseX(ash, cpt); } else { blitterLineDecreaseX(ash, cpt); }
         }
-        bltdpt_local = bltcpt_local;
+        dpt = cpt;
     }
-    bltcon = bltcon & 0x0FFFFFFBF;
-    if (decision_is_signed) bltcon |= 0x00000040;
-    
-    setBltconASH(blit_a_shift_local);
-    bnew   = bltbdat_local;
-    bltapt = CHIP_PTR(decision_variable);
-    bltcpt = CHIP_PTR(bltcpt_local);
-    bltdpt = CHIP_PTR(bltdpt_local);
-    bzero  = bltzero_local;
+
+    if (useC && bltsizeH) mem.dataBus = cdat;
+
+    setBltconASH(ash);
+    bnew   = bdat;
+    bltapt = CHIP_PTR(decision);
+    bltcpt = CHIP_PTR(cpt);
+    bltdpt = CHIP_PTR(dpt);
+    bzero  = any;
 }
+
     /*
      void blitterLineMode(void)
      {
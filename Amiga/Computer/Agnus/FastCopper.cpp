@@ -0,0 +1,249 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+
+#include <algorithm>
+
+/* If precomputation is enabled, the Copper checks the upcoming commands each
+ * time it wakes up. If they form a run of MOVEs into color registers and
+ * WAITs, the run is simulated in advance. The simulation follows the state
+ * machine in serviceEvent(), but it ignores all DMA cycles that are occupied
+ * by other components. The resulting color changes are stored together with
+ * their beam positions and handed over to Denise at the end of each line.
+ * During the run, no Copper events are processed and no bus cycles are
+ * allocated. Hence, this mode trades accuracy for speed.
+ *
+ * A run ends at the first command that cannot be precomputed:
+ *
+ *   - A MOVE into a register other than a color register or NOOP.
+ *   - A SKIP.
+ *   - A WAIT with a cleared Blitter Finish Disable bit.
+ *
+ * No run is started if bitplane DMA occupies even DMA cycles, i.e., in lores
+ * mode with 5 or 6 bitplanes and in hires mode with 3 or more bitplanes.
+ *
+ * The Copper executes this command as usual. A run is aborted if the Copper
+ * list is written to by the CPU or a blit, if the Copper list is switched by
+ * the CPU, if Copper DMA is switched off, or if BPLCON0 is changed such that
+ * bitplane DMA occupies even DMA cycles. In this case, the Copper
+ * continues with the first command that has not been fetched yet. The state
+ * of a run is part of a snapshot. Taking a snapshot does not affect the run.
+ */
+
+bool
+Copper::beginRun(Beam fetch)
+{
+    assert(!runActive);
+
+    // The simulation assumes that the Copper owns all even DMA cycles
+    if (bplDmaBlocksCopper(agnus.bplcon0)) return false;
+
+    int16_t numLines = agnus.frameInfo.numLines;
+
+    // Keep all color changes of the previous run that have not been handed over
+    int pending = runCount - runNext;
+    std::move(runChanges + runNext, runChanges + runCount, runChanges);
+    runCount = pending;
+    runNext = 0;
+
+    uint32_t addr = coppc;
+    Beam pos = dmaCycle(fetch);
+    int count = runCount;
+    int steps = 0;
+    bool sleep = false;
+
+    while (1) {
+
+        // Stop at the end of the frame (the Copper is restarted in VBLANK)
+        if (pos.v >= numLines) { sleep = true; break; }
+
+        // Stop if the buffers are exhausted or the Copper list wraps around
+        if (count == runCapacity || steps == runCapacity) break;
+        if (addr + 4 > mem.chipMask) break;
+
+        // Read via peekChip16() to wait for a parallel blit writing here
+        uint16_t ins1 = mem.peekChip16(addr);
+        uint16_t ins2 = mem.peekChip16(addr + 2);
+
+        // Position where the second instruction word is fetched
+        Beam second = dmaCycle(pos + 2);
+        if (second.v >= numLines) { sleep = true; break; }
+
+        if (!(ins1 & 1)) {
+
+            // MOVE
+            uint16_t reg = ins1 & 0x1FE;
+            bool color = reg >= 0x180 && reg <= 0x1BE;
+            if (!color && reg != 0x1FE) break;
+
+            if (color) {
+                runChanges[count].pos = second;
+                runChanges[count].reg = reg;
+                runChanges[count].value = ins2;
+                count++;
+            }
+            runSteps[steps].fetch = pos;
+            runSteps[steps].addr = addr;
+            steps++;
+
+            pos = dmaCycle(second + 2);
+
+        } else if (!(ins2 & 1) && (ins2 & 0x8000)) {
+
+            // WAIT (with the Blitter Finish Disable bit set)
+            runSteps[steps].fetch = pos;
+            runSteps[steps].addr = addr;
+            steps++;
+
+            // The comparator is run in state COP_WAIT2
+            Beam wait = second + 4;
+            Beam trigger;
+
+            if (!findMatchNew(wait, ins1 & 0xFFFE, (ins2 & 0x7FFE) | 0x8001, trigger)) {
+
+                // The Copper sleeps until the end of the frame
+                addr += 4;
+                sleep = true;
+                break;
+            }
+
+            int delay = trigger - wait;
+
+            if (delay == 0 || delay == 2) {
+
+                // Copper does not stop
+                pos = dmaCycle(wait + 2);
+
+            } else {
+
+                // Copper wakes up with a COP_REQ_DMA event in an even cycle
+                Beam req = agnus.addToBeam(trigger, -2);
+                while (IS_ODD(req.h) || req.h == 0xE0) req = req + 1;
+                pos = dmaCycle(req + 2);
+            }
+
+        } else {
+
+            // SKIP or WAIT (with the Blitter Finish Disable bit cleared)
+            break;
+        }
+
+        addr += 4;
+    }
+
+    // Only precompute runs that are worth the effort
+    if (count - runCount < runMinMoves) return false;
+
+    runCount = count;
+    runNumSteps = steps;
+
+    // Update statistics
+    frameStats.precomputed += steps;
+    for (int i = 0; i < steps; i++) frameStats.lines[runSteps[i].fetch.v]++;
+
+    runActive = true;
+
+    // Dynamically determine the end of the Copper list
+    if (copList == 1) {
+        if (addr > cop1end) cop1end = addr;
+    } else {
+        if (addr > cop2end) cop2end = addr;
+    }
+
+    // Continue with the first command that is not part of the run
+    coppc = addr;
+
+    // Guard the Copper list
+    guardRun();
+    if (sleep) {
+        agnus.scheduleAbs<COP_SLOT>(NEVER, COP_REQ_DMA);
+    } else {
+        agnus.scheduleAbs<COP_SLOT>(agnus.beamToCycle(pos), COP_FETCH);
+    }
+
+    return true;
+}
+
+void
+Copper::endRun()
+{
+    runActive = false;
+    mem.copPending = false;
+}
+
+bool
+Copper::bplDmaBlocksCopper(uint16_t bplcon0)
+{
+    int bpu = Agnus::bpu(bplcon0);
+    return Denise::hires(bplcon0) ? bpu >= 3 : bpu >= 5;
+}
+
+void
+Copper::guardRun()
+{
+    assert(runActive && runNumSteps > 0);
+
+    // The run covers the commands from the first step up to the current coppc
+    mem.copLo = runSteps[0].addr;
+    mem.copHi = coppc;
+    mem.copPending = true;
+}
+
+void
+Copper::discardRun()
+{
+    endRun();
+    runCount = runNext = runNumSteps = 0;
+}
+
+void
+Copper::abortRun()
+{
+    if (!runActive) return;
+
+    Beam now = agnus.pos;
+
+    // Find the first command that has not been fetched yet
+    int i = 0;
+    while (i < runNumSteps && runSteps[i].fetch - now < 0) i++;
+
+    if (i < runNumSteps) {
+
+        Beam fetch = runSteps[i].fetch;
+
+        // Discard the color changes of all remaining commands
+        while (runCount > runNext && runChanges[runCount - 1].pos - fetch >= 0) runCount--;
+
+        // Remove the remaining commands from the statistics
+        frameStats.precomputed -= runNumSteps - i;
+        for (int j = i; j < runNumSteps; j++) frameStats.lines[runSteps[j].fetch.v]--;
+
+        // Continue with executing the remaining commands
+        coppc = runSteps[i].addr;
+        agnus.scheduleAbs<COP_SLOT>(agnus.beamToCycle(fetch), COP_FETCH);
+    }
+
+    endRun();
+}
+
+void
+Copper::deliverRun(int16_t line)
+{
+    // Abort the run if Copper DMA has been switched off
+    if (runActive && !agnus.doCopDMA()) abortRun();
+
+    for (; runNext < runCount && runChanges[runNext].pos.v <= line; runNext++) {
+
+        CopperColorChange &change = runChanges[runNext];
+        if (change.pos.v == line) {
+            pixelEngine.colRegChanges.add(4 * change.pos.h, change.reg, change.value);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+
+/* The parallel Blitter runs long copy blits on a worker thread. When a blit
+ * is handed over, the Chip Ram regions of all DMA channels are published to
+ * the memory. The emulator thread continues until one of the following
+ * events happens:
+ *
+ *   - Chip Ram is written inside the region of any channel.
+ *   - Chip Ram is read inside the region of channel D.
+ *   - A Blitter register is written.
+ *   - The zero flag is read (DMACONR).
+ *   - The Blitter state is inspected, saved, reset, or the emulator pauses.
+ *
+ * In each of these cases, the emulator thread waits for the worker thread.
+ * Hence, the result of the blit is the same as if it had been performed on
+ * the emulator thread. The only exception is the value of the data bus which
+ * keeps its old value instead of the last word fetched by the Blitter.
+ */
+
+static void *
+workerThreadMain(void *thisBlitter)
+{
+    Blitter *blitter = (Blitter *)thisBlitter;
+    blitter->workerLoop();
+    return NULL;
+}
+
+void
+Blitter::workerLoop()
+{
+    pthread_mutex_lock(&workerLock);
+
+    while (1) {
+
+        // Wait for the next job
+        while (!jobPending && !workerExit) {
+            pthread_cond_wait(&workerCond, &workerLock);
+        }
+        if (workerExit) break;
+        jobPending = false;
+
+        // Perform the blit without holding the lock
+        pthread_mutex_unlock(&workerLock);
+        inWorker = true;
+        doKernelCopyBlit();
+        inWorker = false;
+        pthread_mutex_lock(&workerLock);
+
+        // Report completion
+        jobDone = true;
+        pthread_cond_broadcast(&workerCond);
+    }
+
+    pthread_mutex_unlock(&workerLock);
+}
+
+bool
+Blitter::footprint(uint32_t pt, int16_t mod, uint32_t &lo, uint32_t &hi)
+{
+    bool desc = bltconDESC();
+    int64_t incr = desc ? -2 : 2;
+    int64_t step = bltsizeW * incr + (desc ? -mod : mod);
+    int64_t span = 2 * (bltsizeW - 1);
+
+    // Compute the start addresses of the first and the last row
+    int64_t first = pt;
+    int64_t last = pt + (bltsizeH - 1) * step;
+
+    // Compute the lowest and the highest address of both rows
+    int64_t min = desc ? MIN(first, last) - span : MIN(first, last);
+    int64_t max = desc ? MAX(first, last) + 2 : MAX(first, last) + span + 2;
+
+    // Give up if the blit wraps around
+    if (min < 0 || max > (int64_t)mem.chipMask + 1) return false;
+
+    lo = (uint32_t)min;
+    hi = (uint32_t)max;
+    return true;
+}
+
+bool
+Blitter::runParallel()
+{
+    assert(!parallelRunning);
+
+    if (!config.parallel) return false;
+
+    // Only run long blits in parallel
+    if (bltsizeW * bltsizeH < parallelMinWords) return false;
+
+    // Checksums are computed on the emulator thread
+    if (BLT_CHECKSUM <= (int)debugLevel) return false;
+
+    // Compute the regions of all channels
+    uint32_t pt[4] = { bltapt, bltbpt, bltcpt, bltdpt };
+    int16_t mod[4] = { bltamod, bltbmod, bltcmod, bltdmod };
+
+    for (int i = 0; i < 4; i++) {
+
+        mem.blitLo[i] = mem.blitHi[i] = 0;
+
+        if (GET_BIT(bltcon0, 11 - i)) {
+            if (!footprint(pt[i], mod[i], mem.blitLo[i], mem.blitHi[i])) return false;
+        }
+    }
+
+    // Mark all pages that will be written by the blit
+    if (bltconUSED()) {
+        for (uint32_t addr = mem.blitLo[3]; addr < mem.blitHi[3]; addr += 0x1000) {
+            mem.markChipDirty(addr, 1);
+        }
+        mem.markChipDirty(mem.blitHi[3] - 1, 1);
+    }
+
+    // Launch the worker thread when it is needed for the first time
+    if (!workerCreated) {
+        if (pthread_create(&worker, NULL, workerThreadMain, (void *)this) != 0) {
+            warn("Failed to launch the Blitter thread\n");
+            config.parallel = false;
+            return false;
+        }
+        workerCreated = true;
+    }
+
+    // Hand the blit over to the worker thread
+    mem.blitPending = true;
+    parallelRunning = true;
+
+    pthread_mutex_lock(&workerLock);
+    jobDone = false;
+    jobPending = true;
+    pthread_cond_signal(&workerCond);
+    pthread_mutex_unlock(&workerLock);
+
+    return true;
+}
+
+void
+Blitter::finishParallel()
+{
+    pthread_mutex_lock(&workerLock);
+    while (!jobDone) pthread_cond_wait(&workerCond, &workerLock);
+    pthread_mutex_unlock(&workerLock);
+
+    parallelRunning = false;
+    mem.blitPending = false;
+}
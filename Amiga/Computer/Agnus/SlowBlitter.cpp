@@ -807,9 +807,8 @@ Blitter::beginFakeCopyBlit()
     // Only call this function in copy blit mode
     assert(!bltconLINE());
 
-    // Run the fast Blitter
-    int nr = ((bltcon0 >> 7) & 0b11110) | !!bltconDESC();
-    (this->*blitfunc[nr])();
+    // Run the fast Blitter (on the worker thread if possible)
+    if (!runParallel()) doFastCopyBlit();
 
     // Prepare the slow Blitter
     resetXCounter();
@@ -826,8 +825,7 @@ Blitter::beginSlowCopyBlit()
     // Only call this function in copy blit mode
     assert(!bltconLINE());
 
-    static bool verbose = true;
-    if (verbose) { verbose = false; debug("Using the slow copy Blitter\n"); }
+    if (verboseSlowCopy) { verboseSlowCopy = false; debug("Using the slow copy Blitter\n"); }
 
     // Setup parameters
     if (bltconDESC()) {
@@ -871,6 +869,8 @@ Blitter::beginSlowCopyBlit()
     // This let's us compare checksums with the fast Blitter.
     
     BusOwner owner = agnus.busOwner[agnus.pos.h];
+    Cycle limit = agnus.batchLimit;
+    agnus.batchLimit = 0;
 
     while (agnus.hasEvent<BLT_SLOT>()) {
         agnus.busOwner[agnus.pos.h] = BUS_NONE;
@@ -878,6 +878,7 @@ Blitter::beginSlowCopyBlit()
     }
 
     agnus.busOwner[agnus.pos.h] = owner;
+    agnus.batchLimit = limit;
 
 #endif
 }
@@ -9,10 +9,6 @@
 
 #include "Amiga.h"
 
-int CIAREG_DEBUG  = 2;
-int INT_DEBUG     = 2;
-int OCSREG_DEBUG  = 2;
-
 CIA::CIA(int n, Amiga& ref) : nr(n), AmigaComponent(ref)
 {
 	setDescription("CIA");
@@ -160,7 +156,7 @@ CIA::peek(uint16_t addr)
     if (addr == 0 || addr == 1) {
         debug(DSKREG_DEBUG, "Peek($%X) DDRA = $%X DDRB = $%X\n", addr, DDRA, DDRB);
     }
-    debug(CIAREG_DEBUG, "Peek($%X)\n", addr);
+    debug(amiga.ciaRegDebug, "Peek($%X)\n", addr);
 
     wakeUp();
 
@@ -362,7 +358,7 @@ CIA::poke(uint16_t addr, uint8_t value)
     if (addr == 0 || addr == 1) {
         debug(DSKREG_DEBUG, "Poke($%X,$%X) DDRA = $%X DDRB = $%X\n", addr, value, DDRA, DDRB);
     }
-    debug(CIAREG_DEBUG, "Poke($%X,$%X) (%d,%d)\n", addr, value, addr, value);
+    debug(amiga.ciaRegDebug, "Poke($%X,$%X) (%d,%d)\n", addr, value, addr, value);
     
     wakeUp();
     
@@ -700,9 +696,9 @@ CIA::_dump()
 {
     _inspect();
 
-    CIAREG_DEBUG = 1;
-    INT_DEBUG = 1;
-    OCSREG_DEBUG  = 1;
+    amiga.ciaRegDebug = 1;
+    amiga.intDebug = 1;
+    amiga.ocsRegDebug = 1;
 
     msg("                   Clock : %lld\n", clock);
     msg("                Sleeping : %s\n", sleeping ? "yes" : "no");
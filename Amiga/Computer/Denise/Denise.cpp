@@ -8,8 +8,11 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "sse_utils.h"
 
-int dirk = 0;
+#if defined(__SSSE3__)
+#include <x86intrin.h>
+#endif
 
 Denise::Denise(Amiga& ref) : AmigaComponent(ref)
 {
@@ -24,6 +27,11 @@ Denise::Denise(Amiga& ref) : AmigaComponent(ref)
     config.clxSprSpr = true;
     config.clxSprPlf = true;
     config.clxPlfPlf = true;
+    config.renderThread = false;
+
+#if defined(__SSSE3__) && !defined(NDEBUG)
+    testTranslation();
+#endif
 }
 
 void
@@ -114,6 +122,14 @@ Denise::_dumpConfig()
     plainmsg("      clxSprSpr: %d\n", config.clxSprSpr);
     plainmsg("      clxSprPlf: %d\n", config.clxSprPlf);
     plainmsg("      clxPlfPlf: %d\n", config.clxPlfPlf);
+    plainmsg("   renderThread: %d\n", config.renderThread);
+}
+
+void
+Denise::setRenderThread(bool value)
+{
+    config.renderThread = value;
+    pixelEngine.setRenderThread(value);
 }
 
 void
@@ -433,6 +449,34 @@ Denise::spritePixelIsVisible(int hpos)
     return (z & (Z_0 | Z_1 | Z_2 | Z_3)) == 0;
 }
 
+void
+Denise::computeSpriteCoverage(uint64_t *mask)
+{
+    const int words = (HPIXELS + 63) / 64;
+
+    // Quick exit if no sprite has been drawn in this line
+    if (!wasArmed || !config.emulateSprites) {
+        memset(mask, 0, words * sizeof(uint64_t));
+        return;
+    }
+
+    for (int w = 0; w < words; w++) {
+
+        // Only visit the pixels that are covered by a sprite
+        uint64_t covered = 0;
+        for (int x = 0; x < 8; x++) covered |= spriteCover[x][w];
+        if (w == words - 1) covered &= (1ULL << (HPIXELS % 64)) - 1;
+
+        uint64_t bits = 0;
+        for (; covered; covered &= covered - 1) {
+
+            int i = __builtin_ctzll(covered);
+            bits |= (uint64_t)spritePixelIsVisible(64 * w + i) << i;
+        }
+        mask[w] = bits;
+    }
+}
+
 void
 Denise::updateSpritePriorities(uint16_t bplcon2)
 {
@@ -492,42 +536,45 @@ Denise::draw(int pixels)
         spriteClipBegin = currentPixel - 2;
     }
 
-    uint32_t maskOdd, maskEven;
+    int scrollOdd = HIRES ? scrollHiresOdd : scrollLoresOdd;
+    int scrollEven = HIRES ? scrollHiresEven : scrollLoresEven;
 
-    if (HIRES) {
-        maskOdd = 0x8000 << scrollHiresOdd;
-        maskEven = 0x8000 << scrollHiresEven;
-    } else {
-        maskOdd = 0x8000 << scrollLoresOdd;
-        maskEven = 0x8000 << scrollLoresEven;
-    }
+    uint16_t slice[6];
+    uint8_t chunky[16];
 
-    for (int i = 0; i < pixels; i++) {
+    // Convert the shift registers in chunks of 16 pixels
+    for (int offset = 0; offset < pixels; offset += 16) {
 
-        // Read a bit slice
-        index =
-        (!!(shiftReg[0] & maskOdd)  << 0) |
-        (!!(shiftReg[1] & maskEven) << 1) |
-        (!!(shiftReg[2] & maskOdd)  << 2) |
-        (!!(shiftReg[3] & maskEven) << 3) |
-        (!!(shiftReg[4] & maskOdd)  << 4) |
-        (!!(shiftReg[5] & maskEven) << 5);
+        int count = MIN(16, pixels - offset);
 
-        maskOdd >>= 1;
-        maskEven >>= 1;
+        // Extract the next 16 bits of each plane, honouring the scroll values
+        for (int i = 0; i < 6; i += 2) {
+            slice[i] = bitSlice(shiftReg[i], scrollOdd - offset);
+            slice[i + 1] = bitSlice(shiftReg[i + 1], scrollEven - offset);
+        }
 
         if (HIRES) {
 
-            // Synthesize one hires pixel
-            assert(currentPixel < sizeof(bBuffer));
-            bBuffer[currentPixel++] = index;
+            // Synthesize one hires pixel per bit
+            assert(currentPixel + count <= sizeof(bBuffer));
+            if (count == 16) {
+                planarToChunky(slice, bBuffer + currentPixel);
+            } else {
+                planarToChunky(slice, chunky);
+                memcpy(bBuffer + currentPixel, chunky, count);
+            }
+            currentPixel += count;
 
         } else {
 
-            // Synthesize two lores pixels
-            assert(currentPixel + 1 < sizeof(bBuffer));
-            bBuffer[currentPixel++] = index;
-            bBuffer[currentPixel++] = index;
+            // Synthesize two lores pixels per bit
+            assert(currentPixel + 2 * count <= sizeof(bBuffer));
+            planarToChunky(slice, chunky);
+            for (int i = 0; i < count; i++) {
+                index = chunky[i];
+                bBuffer[currentPixel++] = index;
+                bBuffer[currentPixel++] = index;
+            }
         }
     }
 
@@ -603,9 +650,67 @@ Denise::translate()
 void
 Denise::translateSPF(int from, int to)
 {
+    int i = from;
+
+#if defined(__SSSE3__)
+
+    // Translate 16 pixels at a time
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bit4 = _mm_set1_epi8(16);
+    const __m128i z = _mm_set1_epi16(prio2);
+
+    for (; i + 16 <= to; i += 16) {
+
+        __m128i s = _mm_loadu_si128((__m128i *)(bBuffer + i));
+        __m128i transparent = _mm_cmpeq_epi8(s, zero);
+
+        // Skip runs of transparent pixels
+        if (_mm_movemask_epi8(transparent) == 0xFFFF) {
+            _mm_storeu_si128((__m128i *)(iBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(mBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(zBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(zBuffer + i + 8), zero);
+            continue;
+        }
+
+        if (prio2) {
+
+            // Expand the transparency mask to 16 bit
+            __m128i lo = _mm_unpacklo_epi8(transparent, transparent);
+            __m128i hi = _mm_unpackhi_epi8(transparent, transparent);
+
+            _mm_storeu_si128((__m128i *)(iBuffer + i), s);
+            _mm_storeu_si128((__m128i *)(mBuffer + i), s);
+            _mm_storeu_si128((__m128i *)(zBuffer + i), _mm_andnot_si128(lo, z));
+            _mm_storeu_si128((__m128i *)(zBuffer + i + 8), _mm_andnot_si128(hi, z));
+
+        } else {
+
+            // Pixels with bit 4 set are drawn with color 16
+            __m128i set = _mm_cmpeq_epi8(_mm_and_si128(s, bit4), bit4);
+            __m128i index = _mm_or_si128(_mm_and_si128(set, bit4),
+                                         _mm_andnot_si128(set, s));
+
+            _mm_storeu_si128((__m128i *)(iBuffer + i), index);
+            _mm_storeu_si128((__m128i *)(mBuffer + i), index);
+            _mm_storeu_si128((__m128i *)(zBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(zBuffer + i + 8), zero);
+        }
+    }
+
+#endif
+
+    translateSPFScalar(i, to);
+}
+
+void
+Denise::translateSPFScalar(int from, int to)
+{
+    int i = from;
+
     // The usual case: prio2 is a valid value
     if (prio2) {
-        for (int i = from; i < to; i++) {
+        for (; i < to; i++) {
 
             uint8_t s = bBuffer[i];
 
@@ -617,7 +722,7 @@ Denise::translateSPF(int from, int to)
     // The unusual case: prio2 is ivalid
     } else {
 
-        for (int i = from; i < to; i++) {
+        for (; i < to; i++) {
 
              uint8_t s = bBuffer[i];
 
@@ -637,12 +742,111 @@ Denise::translateDPF(bool pf2pri, int from, int to)
 template <bool pf2pri> void
 Denise::translateDPF(int from, int to)
 {
+    int i = from;
+
+#if defined(__SSSE3__)
+
     /* If the priority of a playfield is set to an illegal value (prio1 or
      * prio2 will be 0 in that case), all pixels are drawn transparent.
      */
     uint8_t mask1 = prio1 ? 0b1111 : 0b0000;
     uint8_t mask2 = prio2 ? 0b1111 : 0b0000;
 
+    /* Translate 16 pixels at a time. The color indices of both playfields
+     * are computed by two table lookups, one for each nibble. The lower
+     * three bits of the looked up values hold the PF1 index and the upper
+     * nibble holds the PF2 index.
+     */
+    const __m128i loNibble = _mm_setr_epi8(0x00, 0x01, 0x10, 0x11,
+                                           0x02, 0x03, 0x12, 0x13,
+                                           0x20, 0x21, 0x30, 0x31,
+                                           0x22, 0x23, 0x32, 0x33);
+    const __m128i hiNibble = _mm_setr_epi8(0x00, 0x04, 0x40, 0x44,
+                                           0x00, 0x04, 0x40, 0x44,
+                                           0x00, 0x04, 0x40, 0x44,
+                                           0x00, 0x04, 0x40, 0x44);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bits = _mm_set1_epi8(0x0F);
+    const __m128i seven = _mm_set1_epi8(0x07);
+    const __m128i eight = _mm_set1_epi8(0x08);
+    const __m128i m1 = _mm_set1_epi8(mask1);
+    const __m128i m2 = _mm_set1_epi8(mask2);
+    const __m128i zDpf = _mm_set1_epi16(Z_DPF);
+    const __m128i zPf1 = _mm_set1_epi16(Z_PF1);
+    const __m128i zPf2 = _mm_set1_epi16(Z_PF2);
+    const __m128i p1 = _mm_set1_epi16(prio1);
+    const __m128i p2 = _mm_set1_epi16(prio2);
+
+    for (; i + 16 <= to; i += 16) {
+
+        __m128i s = _mm_loadu_si128((__m128i *)(bBuffer + i));
+
+        // Skip runs of transparent pixels
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i *)(iBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(mBuffer + i), zero);
+            _mm_storeu_si128((__m128i *)(zBuffer + i), zDpf);
+            _mm_storeu_si128((__m128i *)(zBuffer + i + 8), zDpf);
+            continue;
+        }
+
+        // Determine color indices for both playfields
+        __m128i idx = _mm_or_si128(
+            _mm_shuffle_epi8(loNibble, _mm_and_si128(s, bits)),
+            _mm_shuffle_epi8(hiNibble, _mm_and_si128(_mm_srli_epi16(s, 4), bits)));
+        __m128i index1 = _mm_and_si128(idx, seven);
+        __m128i index2 = _mm_and_si128(_mm_srli_epi16(idx, 4), seven);
+
+        // Determine which playfield is solid and which one is visible
+        __m128i solid1 = _mm_xor_si128(_mm_cmpeq_epi8(index1, zero), _mm_cmpeq_epi8(zero, zero));
+        __m128i solid2 = _mm_xor_si128(_mm_cmpeq_epi8(index2, zero), _mm_cmpeq_epi8(zero, zero));
+        __m128i take2 = pf2pri ? solid2 : _mm_andnot_si128(solid1, solid2);
+        __m128i take1 = _mm_andnot_si128(take2, solid1);
+
+        __m128i color1 = _mm_and_si128(index1, m1);
+        __m128i color2 = _mm_and_si128(_mm_or_si128(index2, eight), m2);
+        __m128i color = _mm_or_si128(_mm_and_si128(take1, color1),
+                                     _mm_and_si128(take2, color2));
+
+        _mm_storeu_si128((__m128i *)(iBuffer + i), color);
+        _mm_storeu_si128((__m128i *)(mBuffer + i), color);
+
+        // Compute the depth values in two halves of 8 pixels
+        for (int half = 0; half < 2; half++) {
+
+            __m128i s1, s2, t1, t2;
+            if (half == 0) {
+                s1 = _mm_unpacklo_epi8(solid1, solid1);
+                s2 = _mm_unpacklo_epi8(solid2, solid2);
+                t1 = _mm_unpacklo_epi8(take1, take1);
+                t2 = _mm_unpacklo_epi8(take2, take2);
+            } else {
+                s1 = _mm_unpackhi_epi8(solid1, solid1);
+                s2 = _mm_unpackhi_epi8(solid2, solid2);
+                t1 = _mm_unpackhi_epi8(take1, take1);
+                t2 = _mm_unpackhi_epi8(take2, take2);
+            }
+            __m128i z = _mm_or_si128(zDpf,
+                        _mm_or_si128(_mm_or_si128(_mm_and_si128(s1, zPf1),
+                                                  _mm_and_si128(s2, zPf2)),
+                                     _mm_or_si128(_mm_and_si128(t1, p1),
+                                                  _mm_and_si128(t2, p2))));
+            _mm_storeu_si128((__m128i *)(zBuffer + i + 8 * half), z);
+        }
+    }
+
+#endif
+
+    translateDPFScalar<pf2pri>(i, to);
+}
+
+template <bool pf2pri> void
+Denise::translateDPFScalar(int from, int to)
+{
+    // Illegal priority values make the corresponding playfield transparent
+    uint8_t mask1 = prio1 ? 0b1111 : 0b0000;
+    uint8_t mask2 = prio2 ? 0b1111 : 0b0000;
+
     for (int i = from; i < to; i++) {
 
         uint8_t s = bBuffer[i];
@@ -687,6 +891,52 @@ Denise::translateDPF(int from, int to)
     }
 }
 
+#if defined(__SSSE3__)
+
+void
+Denise::testTranslation()
+{
+    // Test line: All bitplane values surrounded by runs of transparent pixels
+    const int count = 6 * 16 - 3;
+    for (int i = 0; i < count; i++) bBuffer[i] = (i >= 16 && i < 80) ? i - 16 : 0;
+
+    uint8_t iRef[count], mRef[count];
+    uint16_t zRef[count];
+
+    for (uint16_t bplcon2 = 0; bplcon2 < 64; bplcon2++) {
+
+        prio1 = zPF1(bplcon2);
+        prio2 = zPF2(bplcon2);
+
+        // Single playfield, dual playfield (PF1 first), dual playfield (PF2 first)
+        for (int mode = 0; mode < 3; mode++) {
+
+            // Compute the reference result with the scalar code
+            if (mode == 0) translateSPFScalar(0, count);
+            if (mode == 1) translateDPFScalar<false>(0, count);
+            if (mode == 2) translateDPFScalar<true>(0, count);
+
+            memcpy(iRef, iBuffer, sizeof(iRef));
+            memcpy(mRef, mBuffer, sizeof(mRef));
+            memcpy(zRef, zBuffer, sizeof(zRef));
+
+            // Compute the same pixels with the vectorized code
+            if (mode == 0) translateSPF(0, count);
+            if (mode == 1) translateDPF<false>(0, count);
+            if (mode == 2) translateDPF<true>(0, count);
+
+            // Both results have to match bit by bit
+            assert(memcmp(iRef, iBuffer, sizeof(iRef)) == 0);
+            assert(memcmp(mRef, mBuffer, sizeof(mRef)) == 0);
+            assert(memcmp(zRef, zBuffer, sizeof(zRef)) == 0);
+        }
+    }
+
+    prio1 = prio2 = 0;
+}
+
+#endif
+
 void
 Denise::drawSprites()
 {
@@ -694,6 +944,8 @@ Denise::drawSprites()
 
         stats.spriteLines++;
 
+        memset(spriteCover, 0, sizeof(spriteCover));
+
         if (wasArmed & 0b11000000) drawSpritePair<7>();
         if (wasArmed & 0b00110000) drawSpritePair<5>();
         if (wasArmed & 0b00001100) drawSpritePair<3>();
@@ -824,6 +1076,17 @@ Denise::drawSpritePair(int hstrt, int hstop,
             ssrb[x-1] <<= 1;
             ssra[x] <<= 1;
             ssrb[x] <<= 1;
+
+        } else {
+
+            /* The shift registers are empty. Nothing will be drawn until one
+             * of the two sprites is reloaded. Hence, skip to the start of the
+             * next sprite span.
+             */
+            int next = hstop;
+            if (armed1 && strt1 > hpos && strt1 < next && IS_EVEN(strt1 - hpos)) next = strt1;
+            if (armed2 && strt2 > hpos && strt2 < next && IS_EVEN(strt2 - hpos)) next = strt2;
+            hpos = next - 2;
         }
     }
 
@@ -851,6 +1114,9 @@ Denise::drawSpritePixel(int hpos)
         if (z > zBuffer[hpos + 1]) mBuffer[hpos + 1] = base | col;
         zBuffer[hpos] |= z;
         zBuffer[hpos + 1] |= z;
+
+        assert(IS_EVEN(hpos));
+        spriteCover[x][hpos >> 6] |= 3ULL << (hpos & 63);
     }
 }
 
@@ -879,10 +1145,12 @@ Denise::drawAttachedSpritePixelPair(int hpos)
         if (z > zBuffer[hpos]) {
             mBuffer[hpos] = 0b10000 | col;
             zBuffer[hpos] |= z;
+            spriteCover[x][hpos >> 6] |= 1ULL << (hpos & 63);
         }
         if (z > zBuffer[hpos-1]) {
             mBuffer[hpos-1] = 0b10000 | col;
             zBuffer[hpos-1] |= z;
+            spriteCover[x][(hpos-1) >> 6] |= 1ULL << ((hpos-1) & 63);
         }
     }
 }
@@ -942,44 +1210,60 @@ Denise::drawBorder()
 #endif
 }
 
+uint64_t
+Denise::spanMask(int word, int start, int end)
+{
+    int first = 64 * word;
+    uint64_t mask = IS_ODD(end) ? 0xAAAAAAAAAAAAAAAAULL : 0x5555555555555555ULL;
+
+    if (start > first) mask &= ~0ULL << (start - first);
+    if (end < first + 63) mask &= (2ULL << (end - first)) - 1;
+
+    return mask;
+}
+
 template <int x> void
 Denise::checkS2SCollisions(int start, int end)
 {
     // For the odd sprites, only proceed if collision detection is enabled
     if (IS_ODD(x) && !GET_BIT(clxcon, 12 + (x/2))) return;
 
-    // Set up the sprite comparison masks
-    uint16_t comp01 = Z_SP0 | (GET_BIT(clxcon, 12) ? Z_SP1 : 0);
-    uint16_t comp23 = Z_SP2 | (GET_BIT(clxcon, 13) ? Z_SP3 : 0);
-    uint16_t comp45 = Z_SP4 | (GET_BIT(clxcon, 14) ? Z_SP5 : 0);
-    uint16_t comp67 = Z_SP6 | (GET_BIT(clxcon, 15) ? Z_SP7 : 0);
+    end = MIN(end, 64 * spriteCoverWords - 1);
 
-    // Iterate over all sprite pixels
-    for (int pos = end; pos >= start; pos -= 2) {
+    // Iterate over all sprite pixels, 64 pixels at a time
+    for (int w = start >> 6; w <= end >> 6; w++) {
 
-        uint16_t z = zBuffer[pos];
+        uint64_t c[8];
+        for (int i = 0; i < 8; i++) c[i] = spriteCover[i][w];
 
-        // Skip if there are no other sprites at this pixel coordinate
-        if (!(z & (Z_SP01234567 ^ Z_SP[x]))) continue;
+        // Only consider the pixels where this sprite and another sprite are solid
+        uint64_t others = 0;
+        for (int i = 0; i < 8; i++) if (i != x) others |= c[i];
+        uint64_t hits = c[x] & others & spanMask(w, start, end);
 
-        // Skip if the sprite is transparent at this pixel coordinate
-        if (!(z & Z_SP[x])) continue;
+        if (!hits) continue;
+
+        // Set up the sprite comparison masks
+        uint64_t comp01 = c[0] | (GET_BIT(clxcon, 12) ? c[1] : 0);
+        uint64_t comp23 = c[2] | (GET_BIT(clxcon, 13) ? c[3] : 0);
+        uint64_t comp45 = c[4] | (GET_BIT(clxcon, 14) ? c[5] : 0);
+        uint64_t comp67 = c[6] | (GET_BIT(clxcon, 15) ? c[7] : 0);
 
         // Set sprite collision bits
-        if ((z & comp45) && (z & comp67)) SET_BIT(clxdat, 14);
-        if ((z & comp23) && (z & comp67)) SET_BIT(clxdat, 13);
-        if ((z & comp23) && (z & comp45)) SET_BIT(clxdat, 12);
-        if ((z & comp01) && (z & comp67)) SET_BIT(clxdat, 11);
-        if ((z & comp01) && (z & comp45)) SET_BIT(clxdat, 10);
-        if ((z & comp01) && (z & comp23)) SET_BIT(clxdat, 9);
+        if (hits & comp45 & comp67) SET_BIT(clxdat, 14);
+        if (hits & comp23 & comp67) SET_BIT(clxdat, 13);
+        if (hits & comp23 & comp45) SET_BIT(clxdat, 12);
+        if (hits & comp01 & comp67) SET_BIT(clxdat, 11);
+        if (hits & comp01 & comp45) SET_BIT(clxdat, 10);
+        if (hits & comp01 & comp23) SET_BIT(clxdat, 9);
 
         if (CLX_DEBUG == 1) {
-            if ((z & comp45) && (z & comp67)) debug("Collision between 45 and 67\n");
-            if ((z & comp23) && (z & comp67)) debug("Collision between 23 and 67\n");
-            if ((z & comp23) && (z & comp45)) debug("Collision between 23 and 45\n");
-            if ((z & comp01) && (z & comp67)) debug("Collision between 01 and 67\n");
-            if ((z & comp01) && (z & comp45)) debug("Collision between 01 and 45\n");
-            if ((z & comp01) && (z & comp23)) debug("Collision between 01 and 23\n");
+            if (hits & comp45 & comp67) debug("Collision between 45 and 67\n");
+            if (hits & comp23 & comp67) debug("Collision between 23 and 67\n");
+            if (hits & comp23 & comp45) debug("Collision between 23 and 45\n");
+            if (hits & comp01 & comp67) debug("Collision between 01 and 67\n");
+            if (hits & comp01 & comp45) debug("Collision between 01 and 45\n");
+            if (hits & comp01 & comp23) debug("Collision between 01 and 23\n");
         }
     }
 }
@@ -990,54 +1274,43 @@ Denise::checkS2PCollisions(int start, int end)
     // For the odd sprites, only proceed if collision detection is enabled
     if (IS_ODD(x) && !getENSP<x>()) return;
 
-    // Set up the sprite comparison mask
-    uint16_t sprMask;
-    switch(x) {
-        case 0:
-        case 1: sprMask = Z_SP0 | (getENSP<1>() ? Z_SP1 : 0); break;
-        case 2:
-        case 3: sprMask = Z_SP2 | (getENSP<3>() ? Z_SP3 : 0); break;
-        case 4:
-        case 5: sprMask = Z_SP4 | (getENSP<5>() ? Z_SP5 : 0); break;
-        case 6:
-        case 7: sprMask = Z_SP6 | (getENSP<7>() ? Z_SP7 : 0); break;
-
-        default: sprMask = 0; assert(false);
-    }
-
     uint8_t enabled1 = getENBP1();
     uint8_t enabled2 = getENBP2();
     uint8_t compare1 = getMVBP1() & enabled1;
     uint8_t compare2 = getMVBP2() & enabled2;
 
-    // Check for sprite-playfield collisions
-    for (int pos = end; pos >= start; pos -= 2) {
+    end = MIN(end, 64 * spriteCoverWords - 1);
 
-        uint16_t z = zBuffer[pos];
+    // Check for sprite-playfield collisions at all pixels covered by the sprite
+    for (int w = start >> 6; w <= end >> 6; w++) {
 
-        // Skip if the sprite is transparent at this pixel coordinate
-        if (!(z & Z_SP[x])) continue;
+        uint64_t bits = spriteCover[x][w] & spanMask(w, start, end);
 
-        // debug(CLX_DEBUG, "<%d> b[%d] = %X e1 = %X e2 = %X, c1 = %X c2 = %X\n",
-        //     x, pos, bBuffer[pos], enabled1, enabled2, compare1, compare2);
+        for (; bits; bits &= bits - 1) {
 
-        // Check for a collision with playfield 2
-        if ((bBuffer[pos] & enabled2) == compare2) {
-            debug(CLX_DEBUG, "S%d collides with PF2\n", x);
-            SET_BIT(clxdat, 5 + (x / 2));
-            SET_BIT(clxdat, 1 + (x / 2));
+            int pos = 64 * w + __builtin_ctzll(bits);
 
-        } else {
-            // There is a hardware oddity in single-playfield mode. If PF2
-            // doesn't match, playfield 1 doesn't match, too. No matter what.
-            // See http://eab.abime.net/showpost.php?p=965074&postcount=2
-            if ((zBuffer[pos] & Z_DPF) == 0) continue;
-        }
+            // debug(CLX_DEBUG, "<%d> b[%d] = %X e1 = %X e2 = %X, c1 = %X c2 = %X\n",
+            //     x, pos, bBuffer[pos], enabled1, enabled2, compare1, compare2);
 
-        // Check for a collision with playfield 1
-        if ((bBuffer[pos] & enabled1) == compare1) {
-            debug(CLX_DEBUG, "S%d collides with PF1\n", x);
-            SET_BIT(clxdat, 1 + (x / 2));
+            // Check for a collision with playfield 2
+            if ((bBuffer[pos] & enabled2) == compare2) {
+                debug(CLX_DEBUG, "S%d collides with PF2\n", x);
+                SET_BIT(clxdat, 5 + (x / 2));
+                SET_BIT(clxdat, 1 + (x / 2));
+
+            } else {
+                // There is a hardware oddity in single-playfield mode. If PF2
+                // doesn't match, playfield 1 doesn't match, too. No matter what.
+                // See http://eab.abime.net/showpost.php?p=965074&postcount=2
+                if ((zBuffer[pos] & Z_DPF) == 0) continue;
+            }
+
+            // Check for a collision with playfield 1
+            if ((bBuffer[pos] & enabled1) == compare1) {
+                debug(CLX_DEBUG, "S%d collides with PF1\n", x);
+                SET_BIT(clxdat, 1 + (x / 2));
+            }
         }
     }
 }
@@ -1113,6 +1386,40 @@ Denise::beginOfLine(int vpos)
     spriteClipEnd = HPIXELS;
 }
 
+uint64_t
+Denise::lineSignature()
+{
+    // Lines with sprites or DMA debugger overlays are always redrawn
+    if ((wasArmed && config.emulateSprites) || dmaDebugger.isEnabled()) return 0;
+
+    uint64_t hash = fnv_1a_init64();
+
+    // Bitplane data
+    size_t i = 0;
+    for (uint64_t word; i + 8 <= sizeof(bBuffer); i += 8) {
+        memcpy(&word, bBuffer + i, 8);
+        hash = fnv_1a_it64(hash, word);
+    }
+    for (; i < sizeof(bBuffer); i++) {
+        hash = fnv_1a_it64(hash, bBuffer[i]);
+    }
+
+    // Control registers
+    hash = fnv_1a_it64(hash, initialBplcon0 | initialBplcon2 << 16);
+    hash = fnv_1a_it64(hash, bplcon0);
+    hash = conRegChanges.fingerprint(hash);
+
+    // Display window
+    hash = fnv_1a_it64(hash, agnus.diwVFlop | agnus.diwHFlop << 1);
+    hash = fnv_1a_it64(hash, agnus.diwHFlopOn);
+    hash = fnv_1a_it64(hash, agnus.diwHFlopOff);
+
+    // Color registers
+    hash = pixelEngine.colorFingerprint(hash);
+
+    return hash ? hash : 1;
+}
+
 void
 Denise::endOfLine(int vpos)
 {
@@ -1121,6 +1428,27 @@ Denise::endOfLine(int vpos)
     // Check if we are below the VBLANK area
     if (vpos >= 26) {
 
+        uint64_t signature = lineSignature();
+
+        // Check if the frame buffer already contains this line
+        if (pixelEngine.lineIsUnchanged(vpos, signature)) {
+
+            stats.skippedLines++;
+
+            conRegChanges.clear();
+            sprRegChanges.clear();
+
+            // Perform playfield-playfield collision check (if enabled)
+            if (config.clxPlfPlf) checkP2PCollisions();
+
+            // Keep the pixels and apply all color register changes
+            pixelEngine.reuseLine(vpos);
+
+            // Invoke the DMA debugger
+            dmaDebugger.computeOverlay();
+            return;
+        }
+
         // Translate bitplane data to color register indices
         translate();
 
@@ -1134,7 +1462,7 @@ Denise::endOfLine(int vpos)
         if (config.clxPlfPlf) checkP2PCollisions();
 
         // Synthesize RGBA values and write the result into the frame buffer
-        pixelEngine.colorize(vpos);
+        pixelEngine.colorize(vpos, signature);
 
     } else {
         pixelEngine.endOfVBlankLine();
@@ -1370,3 +1698,5 @@ template void Denise::draw<1>(int pixels);
 
 template void Denise::translateDPF<true>(int from, int to);
 template void Denise::translateDPF<false>(int from, int to);
+template void Denise::translateDPFScalar<true>(int from, int to);
+template void Denise::translateDPFScalar<false>(int from, int to);
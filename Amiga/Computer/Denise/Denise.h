@@ -258,6 +258,17 @@ private:
     static const uint16_t Z_SP0246 = Z_SP0|Z_SP2|Z_SP4|Z_SP6;
     static const uint16_t Z_SP1357 = Z_SP1|Z_SP3|Z_SP5|Z_SP7;
 
+    /* Sprite coverage masks
+     * For each sprite, these bit masks mirror the SPx bits of the zBuffer
+     * with one bit per pixel. They allow the collision checks to test 64
+     * pixels at once and to skip all pixels not covered by a sprite.
+     */
+    static const int spriteCoverWords = (sizeof(zBuffer) / sizeof(uint16_t) + 63) / 64;
+    uint64_t spriteCover[8][spriteCoverWords];
+
+    // Returns a mask for all pixels in [start; end] with the same parity as end
+    static uint64_t spanMask(int word, int start, int end);
+
 
     //
     // Constructing and destructing
@@ -349,6 +360,9 @@ public:
     bool getClxPlfPlf() { return config.clxPlfPlf; }
     void setClxPlfPlf(bool value) { config.clxPlfPlf = value; }
 
+    bool getRenderThread() { return config.renderThread; }
+    void setRenderThread(bool value);
+
 
     //
     // Methods from HardwareComponent
@@ -498,6 +512,12 @@ public:
     // Checks the z buffer and returns true if a sprite pixel is visible
     bool spritePixelIsVisible(int hpos);
 
+    /* Computes a bit mask with one bit for each pixel of the current line.
+     * A bit is set if a sprite pixel is visible at the corresponding position.
+     * The mask must provide space for (HPIXELS + 63) / 64 elements.
+     */
+    void computeSpriteCoverage(uint64_t *mask);
+
     // Extracts the sprite priorities from BPLCON2 (DEPRECATED)
     void updateSpritePriorities(uint16_t bplcon2);
 
@@ -514,6 +534,16 @@ public:
     // Synthesizing pixels
     //
     
+private:
+
+    /* Extracts 16 bits from a shift register. The most significant bit of the
+     * result is the bit that is drawn next if the shift register is shifted
+     * by 'shift' bits.
+     */
+    static uint16_t bitSlice(uint32_t reg, int shift) {
+        return (uint16_t)((((uint64_t)reg) << 16) >> (16 + shift));
+    }
+
 public:
 
     // Synthesizes pixels
@@ -533,6 +563,17 @@ private:
     void translateDPF(bool pf2pri, int from, int to);
     template <bool pf2pri> void translateDPF(int from, int to);
 
+    // Portable implementations of translateSPF() and translateDPF()
+    void translateSPFScalar(int from, int to);
+    template <bool pf2pri> void translateDPFScalar(int from, int to);
+
+#if defined(__SSSE3__)
+    /* Checks that the SSSE3 code translates a test line exactly like the
+     * portable code for all playfield priorities. Called once in debug builds.
+     */
+    void testTranslation();
+#endif
+
 
 public:
 
@@ -593,6 +634,12 @@ public:
     // Called by Agnus at the beginning of each rasterline
     void beginOfLine(int vpos);
 
+    /* Computes a signature of all data that affects the visual appearance of
+     * the current line. Returns 0 if the line can't be cached, e.g., if it
+     * contains sprites.
+     */
+    uint64_t lineSignature();
+
     // Called by Agnus at the end of a rasterline
     void endOfLine(int vpos);
 
@@ -54,6 +54,17 @@ inline bool isPalette(long value) {
     return value >= COLOR_PALETTE && value <= SEPIA_PALETTE;
 }
 
+typedef enum : long
+{
+    FRAME_OUTPUT_RGBA = 0,  // Frame buffers contain RGBA values
+    FRAME_OUTPUT_INDEXED    // Frame buffers contain color indices
+}
+FrameOutput;
+
+inline bool isFrameOutput(long value) {
+    return value >= FRAME_OUTPUT_RGBA && value <= FRAME_OUTPUT_INDEXED;
+}
+
 typedef enum
 {
     MODE_SPF = 0, // Single-playfield mode
@@ -76,6 +87,19 @@ typedef struct
     int32_t *data;
     bool longFrame;
     bool interlace;
+
+    // Sequence number of the frame stored in this buffer
+    uint64_t frameNr;
+
+    // Signature of the data in each line (0 = unknown)
+    uint64_t *lineHash;
+
+    /* Bit mask with one bit per line (VPIXELS bits in total). A bit is set if
+     * the line differs from the same line in the previous frame of this type
+     * (long or short). Frame consumers can use this information to upload
+     * changed lines, only.
+     */
+    uint64_t *dirty;
 }
 ScreenBuffer;
 
@@ -107,6 +131,9 @@ typedef struct
 
     // Checks for playfield-playfield collisions
     bool clxPlfPlf;
+
+    // Synthesizes pixels in a separate thread
+    bool renderThread;
 }
 DeniseConfig;
 
@@ -138,6 +165,7 @@ DeniseInfo;
 typedef struct
 {
     long spriteLines;
+    long skippedLines;
 }
 DeniseStats;
 
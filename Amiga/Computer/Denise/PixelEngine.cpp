@@ -9,26 +9,61 @@
 
 #include "Amiga.h"
 
+#if defined(__AVX2__)
+#include <x86intrin.h>
+#endif
+
+int32_t PixelEngine::noise[PixelEngine::noiseSize];
+
+void
+FrameExchange::publish(uint64_t frameNr)
+{
+    buffer[working].frameNr = frameNr;
+    latest = working;
+
+    // Swap the working buffer with the ready buffer
+    int previous = ready.exchange(working | FRESH);
+    if (previous & FRESH) dropped++;
+
+    working = previous & ~FRESH;
+}
+
+int
+FrameExchange::acquireSlot()
+{
+    // Swap the display buffer with the ready buffer if it contains a new frame
+    if (ready.load() & FRESH) {
+        display = ready.exchange(display) & ~FRESH;
+    }
+
+    return display;
+}
+
 PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 {
     setDescription("PixelEngine");
 
     // Allocate frame buffers
-    for (int i = 0; i < 2; i++) {
+    for (int i = 0; i < 3; i++) {
 
-        longFrame[i].data = new int[PIXELS];
-        longFrame[i].longFrame = true;
+        longFrames.buffer[i].data = new int[PIXELS];
+        longFrames.buffer[i].longFrame = true;
+        longFrames.buffer[i].lineHash = new uint64_t[VPIXELS];
+        longFrames.buffer[i].dirty = new uint64_t[dirtyWords];
 
-        shortFrame[i].data = new int[PIXELS];
-        shortFrame[i].longFrame = false;
+        shortFrames.buffer[i].data = new int[PIXELS];
+        shortFrames.buffer[i].longFrame = false;
+        shortFrames.buffer[i].lineHash = new uint64_t[VPIXELS];
+        shortFrames.buffer[i].dirty = new uint64_t[dirtyWords];
     }
+    invalidateLineHashes();
 
-    // Create random background noise pattern
-    const size_t noiseSize = 2 * 512 * 512;
-    noise = new int[noiseSize];
-    for (int i = 0; i < noiseSize; i++) {
-        noise[i] = rand() % 2 ? 0x00000000 : 0x00FFFFFF;
-    }
+    pthread_mutex_init(&renderLock, NULL);
+    pthread_cond_init(&renderCond, NULL);
+
+    // Create the shared background noise pattern (first instance only)
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, initNoise);
 
     // Setup some debug colors
     indexedRgba[64] = GpuColor(0xFF, 0x00, 0x00).rawValue;
@@ -53,41 +88,57 @@ PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 
 PixelEngine::~PixelEngine()
 {
-    for (int i = 0; i < 2; i++) {
-
-        delete[] longFrame[i].data;
-        delete[] shortFrame[i].data;
+    stopRenderThread();
+    pthread_cond_destroy(&renderCond);
+    pthread_mutex_destroy(&renderLock);
+
+    for (int i = 0; i < 3; i++) {
+
+        delete[] longFrames.buffer[i].data;
+        delete[] longFrames.buffer[i].lineHash;
+        delete[] longFrames.buffer[i].dirty;
+        delete[] shortFrames.buffer[i].data;
+        delete[] shortFrames.buffer[i].lineHash;
+        delete[] shortFrames.buffer[i].dirty;
     }
+}
 
-    delete[] noise;
+void
+PixelEngine::initNoise()
+{
+    for (int i = 0; i < noiseSize; i++) {
+        noise[i] = rand() % 2 ? 0x00000000 : 0x00FFFFFF;
+    }
 }
 
 void
 PixelEngine::_powerOn()
 {
+    drainRenderQueue();
+
     // Initialize frame buffers with a checkerboard debug pattern
     for (unsigned line = 0; line < VPIXELS; line++) {
         for (unsigned i = 0; i < HPIXELS; i++) {
 
             int pos = line * HPIXELS + i;
             int col = (line / 4) % 2 == (i / 8) % 2 ? 0x00222222 : 0x00444444;
-            longFrame[0].data[pos] = longFrame[1].data[pos] = col;
-            shortFrame[0].data[pos] = shortFrame[1].data[pos] = col;
+            for (int i = 0; i < 3; i++) {
+                longFrames.buffer[i].data[pos] = shortFrames.buffer[i].data[pos] = col;
+            }
         }
     }
+    invalidateLineHashes();
 }
 
 void
 PixelEngine::_reset()
 {
+    drainRenderQueue();
+
     RESET_SNAPSHOT_ITEMS
 
-    // Initialize frame buffers
-    workingLongFrame = &longFrame[0];
-    workingShortFrame = &shortFrame[0];
-    stableLongFrame = &longFrame[1];
-    stableShortFrame = &shortFrame[1];
-    frameBuffer = &longFrame[0];
+    // Continue with the current long frame working buffer
+    frameBuffer = &longFrames.buffer[longFrames.working];
 
     updateRGBA();
 }
@@ -122,18 +173,181 @@ PixelEngine::setContrast(double value)
 }
 
 void
-PixelEngine::setColor(int reg, uint16_t value)
+PixelEngine::setColor(int reg, uint16_t value, uint16_t *regs, uint32_t *indexed)
 {
     assert(reg < 32);
 
-    colreg[reg] = value & 0xFFF;
+    regs[reg] = value & 0xFFF;
 
     uint8_t r = (value & 0xF00) >> 8;
     uint8_t g = (value & 0x0F0) >> 4;
     uint8_t b = (value & 0x00F);
 
-    indexedRgba[reg] = rgba[value & 0xFFF];
-    indexedRgba[reg + 32] = rgba[((r / 2) << 8) | ((g / 2) << 4) | (b / 2)];
+    indexed[reg] = rgba[value & 0xFFF];
+    indexed[reg + 32] = rgba[((r / 2) << 8) | ((g / 2) << 4) | (b / 2)];
+}
+
+void
+PixelEngine::setFrameOutput(FrameOutput value)
+{
+    if (!isFrameOutput(value)) {
+        warn("Invalid frame output: %ld\n", value);
+        return;
+    }
+
+    amiga.suspend();
+
+    drainRenderQueue();
+    output = value;
+
+    if (output == FRAME_OUTPUT_INDEXED) {
+        for (int i = 0; i < 3; i++) {
+            longFrames.indexed[i].alloc();
+            shortFrames.indexed[i].alloc();
+        }
+    }
+
+    // The cached lines refer to the old format
+    invalidateLineHashes();
+
+    amiga.resume();
+}
+
+static void *
+renderThreadMain(void *engine)
+{
+    ((PixelEngine *)engine)->renderLoop();
+    return NULL;
+}
+
+void
+PixelEngine::setRenderThread(bool enable)
+{
+    if (enable == getRenderThread()) return;
+
+    amiga.suspend();
+
+    if (enable) {
+        startRenderThread();
+    } else {
+        stopRenderThread();
+    }
+
+    amiga.resume();
+}
+
+void
+PixelEngine::startRenderThread()
+{
+    if (getRenderThread()) return;
+
+    debug("Starting render thread\n");
+
+    renderQueue = new SPSCQueue<LineJob, 64>();
+    renderThreadExit = false;
+    pthread_create(&renderThread, NULL, renderThreadMain, (void *)this);
+}
+
+void
+PixelEngine::stopRenderThread()
+{
+    if (!getRenderThread()) return;
+
+    debug("Stopping render thread\n");
+
+    drainRenderQueue();
+
+    pthread_mutex_lock(&renderLock);
+    renderThreadExit = true;
+    pthread_cond_signal(&renderCond);
+    pthread_mutex_unlock(&renderLock);
+    pthread_join(renderThread, NULL);
+
+    delete renderQueue;
+    renderQueue = NULL;
+}
+
+void
+PixelEngine::drainRenderQueue()
+{
+    while (linesCompleted != linesSubmitted) sched_yield();
+}
+
+void
+PixelEngine::renderLoop()
+{
+    while (true) {
+
+        LineJob *job = renderQueue->front();
+
+        // Go to sleep if there is nothing to do
+        if (!job) {
+
+            pthread_mutex_lock(&renderLock);
+            renderThreadWaiting = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (renderQueue->isEmpty() && !renderThreadExit) {
+                pthread_cond_wait(&renderCond, &renderLock);
+            }
+            renderThreadWaiting = false;
+            pthread_mutex_unlock(&renderLock);
+
+            if (renderQueue->isEmpty() && renderThreadExit) break;
+            continue;
+        }
+
+        // Set up the color lookup table
+        for (int i = 0; i < 32; i++) {
+            setColor(i, job->colreg[i], renderColreg, renderRgba);
+        }
+        for (int i = 64; i < rgbaIndexCnt; i++) {
+            renderRgba[i] = indexedRgba[i];
+        }
+
+        colorize(job->dst, job->ham, renderColreg, renderRgba,
+                 job->changes, job->changeCount,
+                 job->mBuffer, job->iBuffer, job->spriteMask, renderHamBuffer);
+
+        renderQueue->pop();
+        linesCompleted++;
+    }
+}
+
+void
+PixelEngine::submitLine(int32_t *dst, bool ham)
+{
+    LineJob *job;
+
+    // Wait for a free slot
+    while (!(job = renderQueue->back())) sched_yield();
+
+    job->dst = dst;
+    job->ham = ham;
+    memcpy(job->colreg, colreg, sizeof(colreg));
+    memcpy(job->mBuffer, denise.mBuffer, HPIXELS);
+
+    if (ham) {
+        memcpy(job->iBuffer, denise.iBuffer, HPIXELS);
+        denise.computeSpriteCoverage(job->spriteMask);
+    }
+
+    // Record all color register changes and apply them to our own registers
+    job->changeCount = 0;
+    for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
+        job->changes[job->changeCount++] = colRegChanges.change[i];
+        applyRegisterChange(colRegChanges.change[i]);
+    }
+
+    linesSubmitted++;
+    renderQueue->push();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Wake up the render thread if it is sleeping
+    if (renderThreadWaiting) {
+        pthread_mutex_lock(&renderLock);
+        pthread_cond_signal(&renderCond);
+        pthread_mutex_unlock(&renderLock);
+    }
 }
 
 void
@@ -158,6 +372,9 @@ PixelEngine::updateRGBA()
 
     // Update all RGBA values that are cached in indexedRgba[]
     for (int i = 0; i < 32; i++) setColor(i, colreg[i]);
+
+    // All cached lines are outdated now
+    invalidateLineHashes();
 }
 
 void
@@ -240,7 +457,7 @@ PixelEngine::adjustRGB(uint8_t &r, uint8_t &g, uint8_t &b)
 bool
 PixelEngine::isLongFrame(ScreenBuffer *buf)
 {
-    bool result = (buf == &longFrame[0] || buf == &longFrame[1]);
+    bool result = (buf >= longFrames.buffer && buf < longFrames.buffer + 3);
     assert(result == buf->longFrame);
     return result;
 }
@@ -248,31 +465,11 @@ PixelEngine::isLongFrame(ScreenBuffer *buf)
 bool
 PixelEngine::isShortFrame(ScreenBuffer *buf)
 {
-    bool result = (buf == &shortFrame[0] || buf == &shortFrame[1]);
+    bool result = (buf >= shortFrames.buffer && buf < shortFrames.buffer + 3);
     assert(result == !buf->longFrame);
     return result;
 }
 
-ScreenBuffer
-PixelEngine::getStableLongFrame()
-{
-    pthread_mutex_lock(&lock);
-    ScreenBuffer result = *stableLongFrame;
-    pthread_mutex_unlock(&lock);
-
-    return result;
-}
-
-ScreenBuffer
-PixelEngine::getStableShortFrame()
-{
-    pthread_mutex_lock(&lock);
-    ScreenBuffer result = *stableShortFrame;
-    pthread_mutex_unlock(&lock);
-
-    return result;
-}
-
 int32_t *
 PixelEngine::getNoise()
 {
@@ -294,38 +491,46 @@ PixelEngine::pixelAddr(int pixel)
 void
 PixelEngine::beginOfFrame(bool interlace)
 {
-    assert(workingLongFrame == &longFrame[0] || workingLongFrame == &longFrame[1]);
-    assert(workingShortFrame == &shortFrame[0] || workingShortFrame == &shortFrame[1]);
-    assert(stableLongFrame == &longFrame[0] || stableLongFrame == &longFrame[1]);
-    assert(stableShortFrame == &shortFrame[0] || stableShortFrame == &shortFrame[1]);
-    assert(workingLongFrame != stableLongFrame);
-    assert(workingShortFrame != stableShortFrame);
-    assert(frameBuffer == workingLongFrame || frameBuffer == workingShortFrame);
+    assert(frameBuffer == &longFrames.buffer[longFrames.working] ||
+           frameBuffer == &shortFrames.buffer[shortFrames.working]);
+
+    // Wait until all lines of the finished frame have been drawn
+    drainRenderQueue();
 
-    pthread_mutex_lock(&lock);
+    // Pass the finished frame to the capture and the shared export (if any)
+    if (Capture *capture = amiga.getCapture()) {
+        capture->recordFrame(frameBuffer,
+                             output == FRAME_OUTPUT_INDEXED ? indexedFrame() : NULL);
+    }
+    if (SharedExport *sharedExport = amiga.getSharedExport()) {
+        sharedExport->publishFrame(frameBuffer,
+                                   output == FRAME_OUTPUT_INDEXED ? indexedFrame() : NULL,
+                                   frameCount);
+    }
 
     if (isLongFrame(frameBuffer)) {
 
-        // Declare the finished buffer stable
-        swap(workingLongFrame, stableLongFrame);
+        // Hand the finished buffer over to the consumer
+        longFrames.publish(frameCount++);
 
         // Select the next buffer to work on
-        frameBuffer = interlace ? workingShortFrame : workingLongFrame;
+        frameBuffer = interlace ?
+        &shortFrames.buffer[shortFrames.working] :
+        &longFrames.buffer[longFrames.working];
 
     } else {
 
         assert(isShortFrame(frameBuffer));
 
-        // Declare the finished buffer stable
-        swap(workingShortFrame, stableShortFrame);
+        // Hand the finished buffer over to the consumer
+        shortFrames.publish(frameCount++);
 
         // Select the next buffer to work on
-        frameBuffer = workingLongFrame;
+        frameBuffer = &longFrames.buffer[longFrames.working];
     }
 
     frameBuffer->interlace = interlace;
-    
-    pthread_mutex_unlock(&lock);
+    memset(frameBuffer->dirty, 0, dirtyWords * sizeof(uint64_t));
 
     dmaDebugger.vSyncHandler();
 }
@@ -337,10 +542,39 @@ PixelEngine::endOfVBlankLine()
     for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
         applyRegisterChange(colRegChanges.change[i]);
     }
+
+    // VBLANK lines are only drawn into by the DMA debugger
+    if (dmaDebugger.isEnabled()) markLine(agnus.pos.v, 0);
+}
+
+void
+PixelEngine::invalidateLineHashes()
+{
+    for (int i = 0; i < 3; i++) {
+
+        memset(longFrames.buffer[i].lineHash, 0, VPIXELS * sizeof(uint64_t));
+        memset(shortFrames.buffer[i].lineHash, 0, VPIXELS * sizeof(uint64_t));
+        memset(longFrames.buffer[i].dirty, 0xFF, dirtyWords * sizeof(uint64_t));
+        memset(shortFrames.buffer[i].dirty, 0xFF, dirtyWords * sizeof(uint64_t));
+    }
+}
+
+void
+PixelEngine::markLine(int line, uint64_t signature)
+{
+    assert(line < VPIXELS);
+
+    FrameExchange &frames = isLongFrame(frameBuffer) ? longFrames : shortFrames;
+    ScreenBuffer *previous = &frames.buffer[frames.latest];
+
+    frameBuffer->lineHash[line] = signature;
+    if (!signature || previous->lineHash[line] != signature) {
+        frameBuffer->dirty[line / 64] |= 1ULL << (line % 64);
+    }
 }
 
 void
-PixelEngine::applyRegisterChange(const Change &change)
+PixelEngine::applyRegisterChange(const Change &change, uint16_t *regs, uint32_t *indexed)
 {
     switch (change.addr) {
 
@@ -353,108 +587,315 @@ PixelEngine::applyRegisterChange(const Change &change)
             assert(change.addr >= 0x180 && change.addr <= 0x1BE);
 
             // debug("Changing color reg %d to %X\n", (change.addr - 0x180) >> 1, change.value);
-            setColor((change.addr - 0x180) >> 1, change.value);
+            setColor((change.addr - 0x180) >> 1, change.value, regs, indexed);
             break;
     }
 }
 
 void
-PixelEngine::colorize(int line)
+PixelEngine::colorize(int line, uint64_t signature)
 {
     // Jump to the first pixel in the specified line in the active frame buffer
     int32_t *dst = frameBuffer->data + line * HPIXELS;
-    int pixel = 0;
 
     // Check for HAM mode
     bool ham = denise.ham();
 
-    // Initialize the HAM mode hold register with the current background color
-    uint16_t hold = colreg[0];
-
     // Add a dummy register change to ensure we draw until the line end
     colRegChanges.add(HPIXELS, REG_NONE, 0);
 
+    // Write color indices instead of RGBA values if requested
+    if (output == FRAME_OUTPUT_INDEXED) {
+
+        writeIndexedLine(line, ham);
+
+    // Hand the line over to the render thread if possible
+    } else if (renderQueue && !dmaDebugger.isEnabled()) {
+
+        submitLine(dst, ham);
+
+    } else {
+
+        Change changes[128];
+        int count = 0;
+
+        for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
+            changes[count++] = colRegChanges.change[i];
+        }
+
+        // Determine the pixels that are covered by sprites
+        if (ham) denise.computeSpriteCoverage(spriteMask);
+
+        colorize(dst, ham, colreg, indexedRgba, changes, count,
+                 denise.mBuffer, denise.iBuffer, spriteMask, hamBuffer);
+    }
+
+    // Clear the history cache
+    colRegChanges.clear();
+
+    // Remember the signature of this line
+    markLine(line, signature);
+}
+
+void
+PixelEngine::colorize(int *dst, bool ham, uint16_t *regs, uint32_t *indexed,
+                      const Change *changes, int count,
+                      const uint8_t *mbuf, const uint8_t *ibuf,
+                      const uint64_t *mask, uint16_t *hamBuf)
+{
+    int pixel = 0;
+
+    // Initialize the HAM mode hold register with the current background color
+    uint16_t hold = regs[0];
+
     // Iterate over all recorded register changes
-    for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
+    for (int i = 0; i < count; i++) {
 
-        Change &change = colRegChanges.change[i];
+        const Change &change = changes[i];
 
         // Colorize a chunk of pixels
         if (ham) {
-            colorizeHAM(dst, pixel, change.trigger, hold);
+            colorizeHAM(dst, ibuf, regs, hamBuf, pixel, change.trigger, hold);
+            colorizeSprites(dst, mbuf, mask, regs, pixel, change.trigger);
         } else {
-            colorize(dst, pixel, change.trigger);
+            colorize(dst, mbuf, indexed, pixel, change.trigger);
         }
         pixel = change.trigger;
 
         // Perform the register change
+        applyRegisterChange(change, regs, indexed);
+    }
+
+    // Wipe out the HBLANK area
+    for (int pixel = 4 * 0x0F; pixel <= 4 * 0x35; pixel++) {
+        dst[pixel] = rgbaHBlank;
+    }
+}
+
+IndexedFrame *
+PixelEngine::indexedFrame()
+{
+    FrameExchange &frames = isLongFrame(frameBuffer) ? longFrames : shortFrames;
+    return &frames.indexed[frameBuffer - frames.buffer];
+}
+
+void
+PixelEngine::writeIndexedLine(int line, bool ham)
+{
+    IndexedFrame *frame = indexedFrame();
+    IndexedFrame::Line &info = frame->line[line];
+    uint16_t *color = frame->color + line * HPIXELS;
+
+    assert(frame->index && frame->color);
+
+    info.ham = ham;
+    memcpy(info.colreg, colreg, sizeof(colreg));
+    info.changes.clear();
+
+    if (!ham) memcpy(frame->index + line * HPIXELS, denise.mBuffer, HPIXELS);
+    if (ham) denise.computeSpriteCoverage(spriteMask);
+
+    int pixel = 0;
+    uint16_t hold = colreg[0];
+
+    for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
+
+        Change &change = colRegChanges.change[i];
+
+        // In HAM mode, store the final colors including all sprite pixels
+        if (ham) {
+
+            decodeHAM(denise.iBuffer, colreg, color, pixel, change.trigger, hold);
+
+            for (int w = pixel / 64; w <= (change.trigger - 1) / 64 && pixel < change.trigger; w++) {
+
+                uint64_t bits = spriteMask[w];
+                int first = 64 * w;
+                if (pixel > first) bits &= ~0ULL << (pixel - first);
+                if (change.trigger < first + 64) bits &= (1ULL << (change.trigger - first)) - 1;
+
+                for (; bits; bits &= bits - 1) {
+                    int j = first + __builtin_ctzll(bits);
+                    color[j] = colreg[denise.mBuffer[j]];
+                }
+            }
+        }
+        pixel = change.trigger;
+
+        info.changes.push_back(change);
         applyRegisterChange(change);
     }
+}
+
+void
+PixelEngine::expandLine(const IndexedFrame *frame, int line, int32_t *dst)
+{
+    assert(frame && line < VPIXELS);
+
+    const IndexedFrame::Line &info = frame->line[line];
+
+    if (info.ham) {
+
+        const uint16_t *color = frame->color + line * HPIXELS;
+        for (int i = 0; i < HPIXELS; i++) dst[i] = rgba[color[i]];
+
+    } else {
+
+        const uint8_t *index = frame->index + line * HPIXELS;
+        uint16_t regs[32];
+        uint32_t indexed[rgbaIndexCnt];
+        int pixel = 0;
+
+        // Restore the color registers at the beginning of the line
+        for (int i = 0; i < 32; i++) setColor(i, info.colreg[i], regs, indexed);
+        for (int i = 64; i < rgbaIndexCnt; i++) indexed[i] = indexedRgba[i];
+
+        for (const Change &change : info.changes) {
+
+            colorize(dst, index, indexed, pixel, (int)change.trigger);
+            pixel = (int)change.trigger;
+            applyRegisterChange(change, regs, indexed);
+        }
+    }
 
     // Wipe out the HBLANK area
     for (int pixel = 4 * 0x0F; pixel <= 4 * 0x35; pixel++) {
         dst[pixel] = rgbaHBlank;
     }
+}
 
-    // Clear the history cache
-    colRegChanges.clear(); 
+void
+PixelEngine::expandFrame(const IndexedFrame *frame, int32_t *dst)
+{
+    for (int line = 0; line < VPIXELS; line++) {
+        expandLine(frame, line, dst + line * HPIXELS);
+    }
 }
 
 void
-PixelEngine::colorize(int *dst, int from, int to)
+PixelEngine::reuseLine(int line)
 {
-    uint8_t *mbuf = denise.mBuffer;
+    // Apply all color register changes that happened in this line
+    for (int i = colRegChanges.begin(); i != colRegChanges.end(); i = colRegChanges.next(i)) {
+        applyRegisterChange(colRegChanges.change[i]);
+    }
+    colRegChanges.clear();
 
-    for (int i = from; i < to; i++) {
-        dst[i] = indexedRgba[mbuf[i]];
+    markLine(line, frameBuffer->lineHash[line]);
+}
+
+uint64_t
+PixelEngine::colorFingerprint(uint64_t hash)
+{
+    for (int i = 0; i < 32; i += 4) {
+        hash = fnv_1a_it64(hash,
+                           (uint64_t)colreg[i] << 48 | (uint64_t)colreg[i + 1] << 32 |
+                           (uint64_t)colreg[i + 2] << 16 | (uint64_t)colreg[i + 3]);
     }
+    return colRegChanges.fingerprint(hash);
 }
 
 void
-PixelEngine::colorizeHAM(int *dst, int from, int to, uint16_t& ham)
+PixelEngine::colorize(int *dst, const uint8_t *mbuf, const uint32_t *indexed,
+                      int from, int to)
 {
-    uint8_t  *ibuf = denise.iBuffer;
-    uint8_t  *mbuf = denise.mBuffer;
+    int i = from;
 
-    for (int i = from; i < to; i++) {
+#if defined(__AVX2__)
 
-        uint8_t index = ibuf[i];
-        assert(isRgbaIndex(index));
+    // Look up 8 pixels at a time
+    for (; i + 8 <= to; i += 8) {
 
-        switch ((index >> 4) & 0b11) {
+        __m128i index = _mm_loadl_epi64((__m128i *)(mbuf + i));
+        __m256i pixels = _mm256_i32gather_epi32((const int *)indexed,
+                                                _mm256_cvtepu8_epi32(index), 4);
+        _mm256_storeu_si256((__m256i *)(dst + i), pixels);
+    }
 
-            case 0b00: // Get color from register
+#endif
 
-                ham = colreg[index];
-                break;
+    for (; i < to; i++) {
+        dst[i] = indexed[mbuf[i]];
+    }
+}
 
-            case 0b01: // Modify blue
+void
+PixelEngine::colorizeHAM(int *dst, const uint8_t *ibuf, const uint16_t *regs,
+                         uint16_t *hamBuf, int from, int to, uint16_t& ham)
+{
+    decodeHAM(ibuf, regs, hamBuf, from, to, ham);
 
-                ham &= 0xFF0;
-                ham |= (index & 0b1111);
-                break;
+    // Synthesize pixels
+    int i = from;
 
-            case 0b10: // Modify red
+#if defined(__AVX2__)
 
-                ham &= 0x0FF;
-                ham |= (index & 0b1111) << 8;
-                break;
+    for (; i + 8 <= to; i += 8) {
 
-            case 0b11: // Modify green
+        __m128i color = _mm_loadu_si128((__m128i *)(hamBuf + i));
+        __m256i pixels = _mm256_i32gather_epi32((const int *)rgba,
+                                                _mm256_cvtepu16_epi32(color), 4);
+        _mm256_storeu_si256((__m256i *)(dst + i), pixels);
+    }
 
-                ham &= 0xF0F;
-                ham |= (index & 0b1111) << 4;
-                break;
+#endif
 
-            default:
-                assert(false);
-        }
+    for (; i < to; i++) {
+        dst[i] = rgba[hamBuf[i]];
+    }
+}
 
-        // Synthesize pixel
-        if (denise.spritePixelIsVisible(i)) {
-            dst[i] = rgba[colreg[mbuf[i]]];
-        } else {
-            dst[i] = rgba[ham];
+void
+PixelEngine::decodeHAM(const uint8_t *ibuf, const uint16_t *regs,
+                       uint16_t *hamBuf, int from, int to, uint16_t& ham)
+{
+    /* Decode the HAM colors. The control bits (bits 4 and 5) of the color
+     * index select the bits that are kept from the previous pixel. The
+     * remaining bits are taken from the table below.
+     *
+     *   00: Get color from register
+     *   01: Modify blue
+     *   10: Modify red
+     *   11: Modify green
+     */
+    static const uint16_t keep[4] = { 0x000, 0xFF0, 0x0FF, 0xF0F };
+    uint16_t set[64];
+
+    for (int i = 0; i < 16; i++) {
+        set[i] = regs[i];
+        set[i | 0x10] = i;
+        set[i | 0x20] = i << 8;
+        set[i | 0x30] = i << 4;
+    }
+
+    for (int i = from; i < to; i++) {
+
+        uint8_t index = ibuf[i];
+        assert(isRgbaIndex(index));
+
+        ham = (ham & keep[(index >> 4) & 0b11]) | set[index & 0x3F];
+        hamBuf[i] = ham;
+    }
+}
+
+void
+PixelEngine::colorizeSprites(int *dst, const uint8_t *mbuf, const uint64_t *mask,
+                             const uint16_t *regs, int from, int to)
+{
+    for (int w = from / 64; w <= (to - 1) / 64 && from < to; w++) {
+
+        uint64_t bits = mask[w];
+
+        // Mask out all pixels outside the specified range
+        int first = 64 * w;
+        if (from > first) bits &= ~0ULL << (from - first);
+        if (to < first + 64) bits &= (1ULL << (to - first)) - 1;
+
+        while (bits) {
+
+            int i = first + __builtin_ctzll(bits);
+            dst[i] = rgba[regs[mbuf[i]]];
+            bits &= bits - 1;
         }
     }
 }
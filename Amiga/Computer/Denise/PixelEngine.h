@@ -12,6 +12,108 @@
 
 #include "AmigaComponent.h"
 #include "ChangeRecorder.h"
+#include "SPSCQueue.h"
+
+#include <atomic>
+
+/* A frame in compact indexed format
+ *
+ * Instead of RGBA values, each pixel is stored as the 8 bit color index
+ * computed by Denise. Lines drawn in HAM mode store the final 12 bit Amiga
+ * color of each pixel instead. In addition, each line stores the color
+ * registers at the beginning of the line together with all color register
+ * changes within the line. This allows the consumer to convert the lines it
+ * needs to RGBA on demand (see PixelEngine::expandLine()).
+ */
+struct IndexedFrame
+{
+    // Color indices of all pixels (PIXELS elements, allocated on demand)
+    uint8_t *index = NULL;
+
+    // 12 bit colors of all pixels in HAM lines (PIXELS elements)
+    uint16_t *color = NULL;
+
+    struct Line
+    {
+        bool ham;
+        uint16_t colreg[32];
+
+        // Color register changes, terminated by a dummy change at HPIXELS
+        vector<Change> changes;
+    };
+    Line line[VPIXELS];
+
+    ~IndexedFrame() { delete [] index; delete [] color; }
+
+    void alloc() {
+        if (!index) index = new uint8_t[PIXELS]();
+        if (!color) color = new uint16_t[PIXELS]();
+    }
+};
+
+/* A lock-free triple buffer for handing over completed frames
+ *
+ * At each point in time, one buffer is the "working buffer" the emulator
+ * draws into, one is the "ready buffer" holding a completed frame, and one is
+ * the "display buffer" owned by the frame consumer. The emulator publishes a
+ * completed frame by atomically exchanging the working buffer with the ready
+ * buffer. The consumer picks up a new frame by exchanging the ready buffer
+ * with its display buffer. Hence, neither side ever has to wait for the other.
+ */
+struct FrameExchange
+{
+    // Bit in 'ready' indicating that the consumer hasn't seen the frame yet
+    static const int FRESH = 4;
+
+    ScreenBuffer buffer[3];
+    IndexedFrame indexed[3];
+
+    // Indices of the working buffer and the most recently completed buffer
+    // (only accessed by the emulator thread)
+    int working = 0;
+    int latest = 1;
+
+    // Index of the ready buffer, possibly combined with the FRESH bit
+    std::atomic<int> ready { 1 };
+
+    // Index of the display buffer (only accessed by the consumer)
+    int display = 2;
+
+    // Number of frames that were replaced before the consumer picked them up
+    std::atomic<long> dropped { 0 };
+
+    // Hands over the working buffer to the consumer (emulator thread)
+    void publish(uint64_t frameNr);
+
+    // Returns the most recent completed frame (consumer thread)
+    ScreenBuffer *acquire() { return &buffer[acquireSlot()]; }
+    IndexedFrame *acquireIndexed() { return &indexed[acquireSlot()]; }
+    int acquireSlot();
+};
+
+// Input data for colorizing a single rasterline on the render thread
+struct LineJob
+{
+    // Start address of the line in the frame buffer
+    int32_t *dst;
+
+    // Indicates if the line is drawn in HAM mode
+    bool ham;
+
+    // Color registers at the beginning of the line
+    uint16_t colreg[32];
+
+    // Color register changes (terminated by a dummy change at HPIXELS)
+    Change changes[128];
+    int changeCount;
+
+    // Color indices computed by Denise
+    uint8_t mBuffer[HPIXELS];
+    uint8_t iBuffer[HPIXELS];
+
+    // Sprite coverage mask (HAM mode only)
+    uint64_t spriteMask[(HPIXELS + 63) / 64];
+};
 
 class PixelEngine : public AmigaComponent {
 
@@ -29,30 +131,31 @@ private:
     // Screen buffers
     //
 
-    /* We keep four frame buffers, two for storing long frames and
-     * another two for storing short frames. The short frame buffers are only
-     * used in interlace mode. At each point in time, one of the two buffers
-     * is the "working buffer" and the other one the "stable buffer". All
-     * drawing functions write to the working buffers, only. The GPU reads from
-     * the stable buffers, only. Once a frame has been completed, the working
-     * buffer and the stable buffer are switched.
+    /* We keep two triple buffers, one for storing long frames and another
+     * one for storing short frames. The short frame buffers are only used in
+     * interlace mode. All drawing functions write to the working buffers,
+     * only. The GPU reads from the display buffers, only. Both buffer types
+     * are exchanged independently. Frame numbers are assigned across both
+     * types, so that the consumer can match long and short frames and detect
+     * dropped frames.
      */
-    ScreenBuffer longFrame[2];
-    ScreenBuffer shortFrame[2];
+    FrameExchange longFrames;
+    FrameExchange shortFrames;
 
-    // Pointers to the working buffers
-    ScreenBuffer *workingLongFrame = &longFrame[0];
-    ScreenBuffer *workingShortFrame = &shortFrame[0];
+    // Pointer to the frame buffer Denise is currently working on
+    ScreenBuffer *frameBuffer = &longFrames.buffer[0];
 
-    // Pointers to the stable buffers
-    ScreenBuffer *stableLongFrame = &longFrame[0];
-    ScreenBuffer *stableShortFrame = &shortFrame[0];
+    // Number of completed frames
+    uint64_t frameCount = 0;
 
-    // Pointer to the frame buffer Denise is currently working on
-    ScreenBuffer *frameBuffer = &longFrame[0];
+    // Number of elements in the dirty line mask of a screen buffer
+    static const int dirtyWords = (VPIXELS + 63) / 64;
 
-    // Buffer storing background noise (random black and white pixels)
-    int32_t *noise;
+    /* Buffer storing background noise (random black and white pixels)
+     * The noise pattern is shared by all instances and created once.
+     */
+    static const size_t noiseSize = 2 * 512 * 512;
+    static int32_t noise[noiseSize];
 
     //
     // Color management
@@ -73,6 +176,13 @@ private:
     static const int rgbaIndexCnt = 32 + 32 + 8;
     uint32_t indexedRgba[rgbaIndexCnt];
 
+    /* HAM mode line buffers
+     * spriteMask: Bit mask marking all pixels covered by a visible sprite
+     *  hamBuffer: Decoded 12 bit HAM colors
+     */
+    uint64_t spriteMask[(HPIXELS + 63) / 64];
+    uint16_t hamBuffer[HPIXELS];
+
     // Color adjustment parameters
     Palette palette = COLOR_PALETTE;
     double brightness = 50.0;
@@ -82,7 +192,37 @@ private:
 
     // The current drawing mode
     DrawingMode mode;
-    
+
+    // The format of the produced frames
+    FrameOutput output = FRAME_OUTPUT_RGBA;
+
+
+    //
+    // Render thread
+    //
+
+    /* If the render thread is enabled, colorize() hands over each line to a
+     * worker thread that synthesizes the RGBA values in parallel to the
+     * emulator thread. The queue is drained at the end of each frame.
+     */
+    SPSCQueue<LineJob, 64> *renderQueue = NULL;
+    pthread_t renderThread;
+
+    // Signals the render thread that the queue is no longer empty
+    pthread_mutex_t renderLock;
+    pthread_cond_t renderCond;
+    std::atomic<bool> renderThreadWaiting { false };
+    std::atomic<bool> renderThreadExit { false };
+
+    // Number of lines handed over and completed
+    std::atomic<long> linesSubmitted { 0 };
+    std::atomic<long> linesCompleted { 0 };
+
+    // Color state of the render thread
+    uint16_t renderColreg[32];
+    uint32_t renderRgba[rgbaIndexCnt];
+    uint16_t renderHamBuffer[HPIXELS];
+
 
     //
     // Register change history buffer
@@ -102,6 +242,9 @@ public:
     PixelEngine(Amiga& ref);
     ~PixelEngine();
 
+    // Creates the shared background noise pattern
+    static void initNoise();
+
 
     //
     // Iterating over snapshot items
@@ -155,6 +298,38 @@ public:
     void setContrast(double value);
 
 
+    //
+    // Controlling the render thread
+    //
+
+public:
+
+    /* Starts or stops the render thread.
+     * The emulator is suspended while the thread is started or stopped. Use
+     * Amiga::configure(VA_RENDER_THREAD, ...) to change this setting.
+     */
+    bool getRenderThread() { return renderQueue != NULL; }
+    void setRenderThread(bool enable);
+
+    FrameOutput getFrameOutput() { return output; }
+    void setFrameOutput(FrameOutput value);
+
+    // Waits until the render thread has processed all pending lines
+    void drainRenderQueue();
+
+    // Entry point of the render thread
+    void renderLoop();
+
+private:
+
+    // Called by setRenderThread() and the destructor
+    void startRenderThread();
+    void stopRenderThread();
+
+    // Hands over the current line to the render thread
+    void submitLine(int32_t *dst, bool ham);
+
+
     //
     // Accessing color registers
     //
@@ -165,7 +340,8 @@ public:
     static bool isRgbaIndex(int nr) { return nr < rgbaIndexCnt; }
     
     // Changes one of the 32 Amiga color registers.
-    void setColor(int reg, uint16_t value);
+    void setColor(int reg, uint16_t value) { setColor(reg, value, colreg, indexedRgba); }
+    void setColor(int reg, uint16_t value, uint16_t *regs, uint32_t *indexed);
 
     // Returns a color value in Amiga format or RGBA format
     uint16_t getColor(int nr) { assert(nr < 32); return colreg[nr]; }
@@ -203,11 +379,41 @@ private:
 
 public:
 
-    // Returns the stable frame buffer for long frames
-    ScreenBuffer getStableLongFrame();
+    /* Returns the most recent long frame or short frame. These functions are
+     * meant to be called by a single frame consumer (the GPU) and never block.
+     * The returned buffer stays valid until the function is called again.
+     */
+    ScreenBuffer getStableLongFrame() { return *longFrames.acquire(); }
+    ScreenBuffer getStableShortFrame() { return *shortFrames.acquire(); }
+
+    /* Returns the most recently completed long frame. This function is meant
+     * to be called by the emulator thread or while the emulator is paused.
+     */
+    ScreenBuffer getLatestLongFrame() { return longFrames.buffer[longFrames.latest]; }
+
+    // Returns the number of frames the consumer has missed
+    long droppedFrames() { return longFrames.dropped + shortFrames.dropped; }
 
-    // Returns the stable frame buffer for short frames
-    ScreenBuffer getStableShortFrame();
+    // Counterparts of the functions above for the indexed frame output
+    IndexedFrame *getStableIndexedLongFrame() { return longFrames.acquireIndexed(); }
+    IndexedFrame *getStableIndexedShortFrame() { return shortFrames.acquireIndexed(); }
+    IndexedFrame *getLatestIndexedLongFrame() { return &longFrames.indexed[longFrames.latest]; }
+
+    // Converts a line of an indexed frame to RGBA
+    void expandLine(const IndexedFrame *frame, int line, int32_t *dst);
+
+    // Converts an entire indexed frame to RGBA (dst must hold PIXELS elements)
+    void expandFrame(const IndexedFrame *frame, int32_t *dst);
+
+private:
+
+    // Returns the indexed frame belonging to the current frame buffer
+    IndexedFrame *indexedFrame();
+
+    // Writes the current line into the indexed frame
+    void writeIndexedLine(int line, bool ham);
+
+public:
 
     // Returns a pointer to randon noise
     int32_t *getNoise();
@@ -218,6 +424,12 @@ public:
     // Called after each line in the VBLANK area
     void endOfVBlankLine();
 
+    // Invalidates the line signatures of all frame buffers
+    void invalidateLineHashes();
+
+    // Marks a line of the current frame buffer as changed or unchanged
+    void markLine(int line, uint64_t signature);
+
     // Called after each frame to switch the frame buffers
     void beginOfFrame(bool interlace);
 
@@ -229,7 +441,10 @@ public:
 public:
 
     // Applies a register change
-    void applyRegisterChange(const Change &change);
+    void applyRegisterChange(const Change &change) {
+        applyRegisterChange(change, colreg, indexedRgba);
+    }
+    void applyRegisterChange(const Change &change, uint16_t *regs, uint32_t *indexed);
 
 
     //
@@ -243,12 +458,43 @@ public:
      * pipelile. It translates a line of color register indices into a line
      * of RGBA values in GPU format.
      */
-    void colorize(int line);
+    void colorize(int line, uint64_t signature = 0);
+
+    /* Checks if the current frame buffer already contains a line with the
+     * specified signature. In that case, the line doesn't need to be redrawn.
+     */
+    bool lineIsUnchanged(int line, uint64_t signature) {
+        return signature && frameBuffer->lineHash[line] == signature;
+    }
+
+    // Called instead of colorize() if a line doesn't need to be redrawn
+    void reuseLine(int line);
+
+    // Computes a fingerprint of the color registers and all recorded changes
+    uint64_t colorFingerprint(uint64_t hash);
 
 private:
 
-    void colorize(int *dst, int from, int to);
-    void colorizeHAM(int *dst, int from, int to, uint16_t& ham);
+    /* Colorizes a complete line. The function is used by both the emulator
+     * thread and the render thread. Hence, all color state is passed in.
+     */
+    void colorize(int *dst, bool ham, uint16_t *regs, uint32_t *indexed,
+                  const Change *changes, int count,
+                  const uint8_t *mbuf, const uint8_t *ibuf,
+                  const uint64_t *mask, uint16_t *hamBuf);
+
+    void colorize(int *dst, const uint8_t *mbuf, const uint32_t *indexed,
+                  int from, int to);
+    void colorizeHAM(int *dst, const uint8_t *ibuf, const uint16_t *regs,
+                     uint16_t *hamBuf, int from, int to, uint16_t& ham);
+
+    // Computes the 12 bit colors of a chunk of HAM pixels
+    void decodeHAM(const uint8_t *ibuf, const uint16_t *regs,
+                   uint16_t *hamBuf, int from, int to, uint16_t& ham);
+
+    // Overwrites all pixels in [from; to) that are covered by a sprite
+    void colorizeSprites(int *dst, const uint8_t *mbuf, const uint64_t *mask,
+                         const uint16_t *regs, int from, int to);
 
 };
 
@@ -16,6 +16,9 @@ Memory::Memory(Amiga& ref) : AmigaComponent(ref)
 
     memset(&config, 0, sizeof(config));
     config.extStart = 0xE0;
+
+    memset(pageHash, 0, sizeof(pageHash));
+    markAllPagesDirty();
 }
 
 Memory::~Memory()
@@ -162,6 +165,9 @@ Memory::didLoadFromBuffer(uint8_t *buffer)
     reader.copy(slow, config.slowSize);
     reader.copy(fast, config.fastSize);
 
+    // Invalidate all cached page hashes
+    markAllPagesDirty();
+
     return reader.ptr - buffer;
 }
 
@@ -219,6 +225,7 @@ Memory::alloc(size_t bytes, uint8_t *&ptr, size_t &size, uint32_t &mask)
         memset(ptr, 0, allocSize);
     }
 
+    markAllPagesDirty();
     updateMemSrcTable();
     return true;
 }
@@ -232,6 +239,68 @@ Memory::fillRamWithStartupPattern()
     if (chip) memset(chip, 0, config.chipSize);
     if (slow) memset(slow, 0, config.slowSize);
     if (fast) memset(fast, 0, config.fastSize);
+
+    markAllPagesDirty();
+}
+
+void
+Memory::syncBlitter(uint32_t addr, int bytes, bool write)
+{
+    uint32_t lo = addr & chipMask;
+    uint32_t hi = lo + bytes;
+
+    // Reads only conflict with the target channel, writes with all channels
+    for (int i = write ? 0 : 3; i < 4; i++) {
+
+        if (lo < blitHi[i] && hi > blitLo[i]) {
+            blitter.sync();
+            return;
+        }
+    }
+}
+
+void
+Memory::syncCopper(uint32_t addr, int bytes)
+{
+    uint32_t lo = addr & chipMask;
+    uint32_t hi = lo + bytes;
+
+    if (lo < copHi && hi > copLo) copper.abortRun();
+}
+
+uint64_t
+Memory::ramHash()
+{
+    uint64_t hash = fnv_1a_init64();
+
+    // Wait until all pending Blitter writes have been performed
+    blitter.sync();
+
+    hash = hashPages(chip, config.chipSize, 0x000000, hash);
+    hash = hashPages(slow, config.slowSize, 0xC00000, hash);
+    hash = hashPages(fast, config.fastSize, FAST_RAM_STRT, hash);
+    hash = hashPages(wom, config.womSize, 0xF80000, hash);
+
+    memset(dirtyPages, 0, sizeof(dirtyPages));
+    return hash;
+}
+
+uint64_t
+Memory::hashPages(uint8_t *ptr, size_t size, uint32_t base, uint64_t hash)
+{
+    if (ptr == NULL) return hash;
+
+    for (size_t offset = 0; offset < size; offset += 4096) {
+
+        uint32_t page = ((base + offset) >> 12) & 0xFFF;
+
+        if (dirtyPages[page >> 6] & (1ULL << (page & 63))) {
+            pageHash[page] = fnv_1a_64(ptr + offset, MIN(size - offset, 4096));
+        }
+        hash = fnv_1a_it64(hash, pageHash[page]);
+    }
+
+    return hash;
 }
 
 RomRevision
@@ -467,8 +536,6 @@ Memory::released(RomRevision rev)
 const char *
 Memory::romVersion()
 {
-    static char str[32];
-
     if (romRevision() == ROM_UNKNOWN) {
         sprintf(str, "CRC %x", romFingerprint());
         return str;
@@ -480,8 +547,6 @@ Memory::romVersion()
 const char *
 Memory::extVersion()
 {
-    static char str[32];
-
     if (extRevision() == ROM_UNKNOWN) {
         sprintf(str, "CRC %x", extFingerprint());
         return str;
@@ -704,6 +769,7 @@ Memory::peek8(uint32_t addr)
             ASSERT_CHIP_ADDR(addr);
             agnus.executeUntilBusIsFree();
             stats.chipReads++;
+            willReadChip(addr, 1);
             dataBus = READ_CHIP_8(addr);
             return dataBus;
 
@@ -793,6 +859,7 @@ Memory::peek16(uint32_t addr)
         case BUS_COPPER:
 
             ASSERT_CHIP_ADDR(addr);
+            willReadChip(addr, 2);
             dataBus = (memSrc[addr >> 16] == MEM_UNMAPPED) ? 0 : READ_CHIP_16(addr);
             return dataBus;
 
@@ -818,6 +885,7 @@ Memory::peek16(uint32_t addr)
                     ASSERT_CHIP_ADDR(addr);
                     agnus.executeUntilBusIsFree();
                     stats.chipReads++;
+                    willReadChip(addr, 2);
                     dataBus = READ_CHIP_16(addr);
                     return dataBus;
 
@@ -968,6 +1036,8 @@ Memory::poke8(uint32_t addr, uint8_t value)
 
             ASSERT_CHIP_ADDR(addr);
             stats.chipWrites++;
+            willWriteChip(addr, 1);
+            markChipDirty(addr, 1);
             WRITE_CHIP_8(addr, value);
             break;
 
@@ -975,6 +1045,7 @@ Memory::poke8(uint32_t addr, uint8_t value)
 
             ASSERT_FAST_ADDR(addr);
             stats.fastWrites++;
+            markFastDirty(addr, 1);
             WRITE_FAST_8(addr, value);
             break;
 
@@ -989,6 +1060,7 @@ Memory::poke8(uint32_t addr, uint8_t value)
 
             ASSERT_SLOW_ADDR(addr);
             stats.chipWrites++;
+            markSlowDirty(addr, 1);
             WRITE_SLOW_8(addr, value);
             break;
 
@@ -1052,13 +1124,21 @@ Memory::poke16(uint32_t addr, uint16_t value)
         case BUS_COPPER:
 
             ASSERT_CHIP_ADDR(addr);
-            if (memSrc[addr >> 16] != MEM_UNMAPPED) WRITE_CHIP_16(addr, value);
+            if (memSrc[addr >> 16] != MEM_UNMAPPED) {
+                willWriteChip(addr, 2);
+                markChipDirty(addr, 2);
+                WRITE_CHIP_16(addr, value);
+            }
             return;
 
         case BUS_BLITTER:
 
             ASSERT_CHIP_ADDR(addr);
-            if (memSrc[addr >> 16] != MEM_UNMAPPED) WRITE_CHIP_16(addr, value);
+            if (memSrc[addr >> 16] != MEM_UNMAPPED) {
+                if (unlikely(copPending)) syncCopper(addr, 2);
+                markChipDirty(addr, 2);
+                WRITE_CHIP_16(addr, value);
+            }
             return;
 
         case BUS_CPU:
@@ -1078,6 +1158,8 @@ Memory::poke16(uint32_t addr, uint16_t value)
                     agnus.executeUntilBusIsFree();
                     stats.chipWrites++;
                     dataBus = value;
+                    willWriteChip(addr, 2);
+                    markChipDirty(addr, 2);
                     WRITE_CHIP_16(addr, value);
                     return;
 
@@ -1085,6 +1167,7 @@ Memory::poke16(uint32_t addr, uint16_t value)
 
                     ASSERT_FAST_ADDR(addr);
                     stats.fastWrites++;
+                    markFastDirty(addr, 2);
                     WRITE_FAST_16(addr, value);
                     return;
 
@@ -1103,6 +1186,7 @@ Memory::poke16(uint32_t addr, uint16_t value)
                     agnus.executeUntilBusIsFree();
                     stats.chipWrites++;
                     dataBus = value;
+                    markSlowDirty(addr, 2);
                     WRITE_SLOW_16(addr, value);
                     return;
 
@@ -1425,7 +1509,7 @@ Memory::peekCustom16(uint32_t addr)
 
     }
 
-    debug(OCSREG_DEBUG, "peekCustom16(%X [%s]) = %X\n",
+    debug(amiga.ocsRegDebug, "peekCustom16(%X [%s]) = %X\n",
           addr, customReg[(addr >> 1) & 0xFF], result);
 
     dataBus = result;
@@ -1515,7 +1599,7 @@ Memory::pokeCustom16(uint32_t addr, uint16_t value)
     if ((addr & 0xFFF) == 0x30) {
         debug("pokeCustom16(SERDAT, '%c')\n", (char)value);
     } else {
-        debug(OCSREG_DEBUG, "pokeCustom16(%X [%s], %X)\n",
+        debug(amiga.ocsRegDebug, "pokeCustom16(%X [%s], %X)\n",
               addr, customReg[(addr >> 1) & 0xFF], value);
     }
 
@@ -1523,6 +1607,9 @@ Memory::pokeCustom16(uint32_t addr, uint16_t value)
 
     dataBus = value;
 
+    // Complete a blit running in parallel before a Blitter register changes
+    if ((addr & 0x1FE) >= 0x040 && (addr & 0x1FE) <= 0x074) blitter.sync();
+
     switch ((addr >> 1) & 0xFF) {
 
         case 0x020 >> 1: // DSKPTH
@@ -2047,6 +2134,7 @@ Memory::pokeWom8(uint32_t addr, uint8_t value)
     // debug("pokeWom8(%X, %X)\n", addr, value);
 
     if (!womIsLocked) {
+        markWomDirty(addr, 1);
         WRITE_WOM_8(addr, value);
     }
 
@@ -2058,6 +2146,7 @@ Memory::pokeWom16(uint32_t addr, uint16_t value)
     // debug("pokeWom16(%X, %X)\n", addr, value);
 
     if (!womIsLocked) {
+        markWomDirty(addr, 2);
         WRITE_WOM_16(addr, value);
     }
 }
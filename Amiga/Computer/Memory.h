@@ -187,6 +187,17 @@ public:
 
     // Buffer for returning string values
     char str[256];
+
+    /* Dirty page bitmap
+     * To compute state hashes efficiently, Ram is divided into pages of 4 KB
+     * which are indexed by their location in the 24-bit address space. Each
+     * write access into Chip Ram, Slow Ram, Fast Ram, or the WOM marks the
+     * affected page as dirty. The hash of a page is cached in pageHash and
+     * only recomputed if the page has been written to in the meantime.
+     * See also: ramHash()
+     */
+    uint64_t dirtyPages[64];
+    uint64_t pageHash[4096];
     
 
     //
@@ -314,6 +325,94 @@ public:
 
     void fillRamWithStartupPattern();
 
+
+    //
+    // Tracking modified pages
+    //
+
+public:
+
+    // Marks all pages as modified
+    void markAllPagesDirty() { memset(dirtyPages, 0xFF, sizeof(dirtyPages)); }
+
+    // Marks the pages touched by a write access as modified
+    inline void markDirty(uint32_t offset, int bytes) {
+        uint32_t first = (offset >> 12) & 0xFFF;
+        uint32_t last = ((offset + bytes - 1) >> 12) & 0xFFF;
+        dirtyPages[first >> 6] |= 1ULL << (first & 63);
+        dirtyPages[last >> 6] |= 1ULL << (last & 63);
+    }
+    inline void markChipDirty(uint32_t addr, int bytes) {
+        markDirty(addr & chipMask, bytes);
+    }
+    inline void markSlowDirty(uint32_t addr, int bytes) {
+        markDirty(0xC00000 | (addr & slowMask), bytes);
+    }
+    inline void markFastDirty(uint32_t addr, int bytes) {
+        markDirty(addr, bytes);
+    }
+    inline void markWomDirty(uint32_t addr, int bytes) {
+        markDirty(0xF80000 | (addr & womMask), bytes);
+    }
+
+
+
+    //
+    // Synchronizing with the parallel Blitter
+    //
+
+public:
+
+    /* Chip Ram regions of a blit running on the Blitter's worker thread
+     * The regions are half-open intervals of Chip Ram offsets, indexed by
+     * the DMA channel (A, B, C, D). Regions of unused channels are empty.
+     */
+    uint32_t blitLo[4];
+    uint32_t blitHi[4];
+
+    // Indicates if a blit is running on the Blitter's worker thread
+    bool blitPending = false;
+
+    /* Chip Ram region holding the commands of a precomputed Copper run
+     * The region is a half-open interval of Chip Ram offsets.
+     */
+    uint32_t copLo = 0;
+    uint32_t copHi = 0;
+
+    // Indicates if a precomputed Copper run is in progress
+    bool copPending = false;
+
+    // Called before Chip Ram is accessed by a component other than the Blitter
+    inline void willReadChip(uint32_t addr, int bytes) {
+        if (unlikely(blitPending)) syncBlitter(addr, bytes, false);
+    }
+    inline void willWriteChip(uint32_t addr, int bytes) {
+        if (unlikely(blitPending)) syncBlitter(addr, bytes, true);
+        if (unlikely(copPending)) syncCopper(addr, bytes);
+    }
+
+private:
+
+    // Waits for the Blitter if an access hits the region of the running blit
+    void syncBlitter(uint32_t addr, int bytes, bool write);
+
+    // Aborts the precomputed Copper run if a write hits the Copper list
+    void syncCopper(uint32_t addr, int bytes);
+
+public:
+
+    /* Computes a hash value over the contents of all Ram types.
+     * Only pages that have been modified since the last call are rehashed.
+     * Roms are not taken into account, because their contents never changes
+     * while the emulator is running.
+     */
+    uint64_t ramHash();
+
+private:
+
+    // Rehashes all dirty pages of a single Ram type and chains the results
+    uint64_t hashPages(uint8_t *ptr, size_t size, uint32_t base, uint64_t hash);
+
     
     //
     // Managing ROM
@@ -418,33 +517,33 @@ public:
     //
     
     inline uint8_t peekChip8(uint32_t addr) {
-        ASSERT_CHIP_ADDR(addr); return READ_CHIP_8(addr);
+        ASSERT_CHIP_ADDR(addr); willReadChip(addr, 1); return READ_CHIP_8(addr);
     }
     inline uint16_t peekChip16(uint32_t addr) {
-        ASSERT_CHIP_ADDR(addr); return READ_CHIP_16(addr);
+        ASSERT_CHIP_ADDR(addr); willReadChip(addr, 2); return READ_CHIP_16(addr);
     }
     inline uint32_t peekChip32(uint32_t addr) {
-        ASSERT_CHIP_ADDR(addr); return READ_CHIP_32(addr);
+        ASSERT_CHIP_ADDR(addr); willReadChip(addr, 4); return READ_CHIP_32(addr);
     }
     
     inline uint8_t spypeekChip8(uint32_t addr) {
-        return peekChip8(addr);
+        ASSERT_CHIP_ADDR(addr); return READ_CHIP_8(addr);
     }
     inline uint16_t spypeekChip16(uint32_t addr) {
-        return peekChip16(addr);
+        ASSERT_CHIP_ADDR(addr); return READ_CHIP_16(addr);
     }
     inline uint32_t spypeekChip32(uint32_t addr) {
-        return peekChip32(addr);
+        ASSERT_CHIP_ADDR(addr); return READ_CHIP_32(addr);
     }
     
     inline void pokeChip8(uint32_t addr, uint8_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_8(addr, value);
+        ASSERT_CHIP_ADDR(addr); willWriteChip(addr, 1); markChipDirty(addr, 1); WRITE_CHIP_8(addr, value);
     }
     inline void pokeChip16(uint32_t addr, uint16_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_16(addr, value);
+        ASSERT_CHIP_ADDR(addr); willWriteChip(addr, 2); markChipDirty(addr, 2); WRITE_CHIP_16(addr, value);
     }
     inline void pokeChip32(uint32_t addr, uint32_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_32(addr, value);
+        ASSERT_CHIP_ADDR(addr); willWriteChip(addr, 4); markChipDirty(addr, 4); WRITE_CHIP_32(addr, value);
     }
     
     //
@@ -23,9 +23,15 @@ namespace moira {
 #include "StrWriter_cpp.h"
 #include "MoiraDasm_cpp.h"
 
+void (Moira::*Moira::exec[65536])(u16);
+void (Moira::*Moira::dasm[65536])(StrWriter&, u32&, u16);
+InstrInfo Moira::info[65536];
+
 Moira::Moira()
 {
-    createJumpTables();
+    // Set up the shared jump tables when the first instance is created
+    static bool initialized = (createJumpTables(), true);
+    (void)initialized;
 }
 
 void
@@ -118,14 +118,18 @@ protected:
     // Value on the lower two function code pins (FC1|FC0)
     u8 fcl;
     
+    /* The following tables don't depend on the CPU state. They are shared
+     * by all instances and set up once when the first instance is created.
+     */
+
     // Jump table holding the instruction handlers
-    void (Moira::*exec[65536])(u16);
+    static void (Moira::*exec[65536])(u16);
 
     // Jump table holding the disassebler handlers
-    void (Moira::*dasm[65536])(StrWriter&, u32&, u16);
+    static void (Moira::*dasm[65536])(StrWriter&, u32&, u16);
 
     // Table holding instruction infos
-    InstrInfo info[65536];
+    static InstrInfo info[65536];
 
 
     //
@@ -135,7 +139,7 @@ protected:
 public:
 
     Moira();
-    void createJumpTables();
+    static void createJumpTables();
 
     // Configures the output format of the disassembler
     void configDasm(bool h, bool u) { hex = h; upper = u; }
@@ -344,6 +344,12 @@ AudioUnit::writeData(short left, short right)
     ringBufferL[writePtr] = fl;
     ringBufferR[writePtr] = fr;
     advanceWritePtr();
+
+    // Record samples in the tap if requested
+    if (tapEnabled) {
+        tap.push_back((int16_t)MAX(-32768.0f, MIN(32767.0f, fl / scale)));
+        tap.push_back((int16_t)MAX(-32768.0f, MIN(32767.0f, fr / scale)));
+    }
 }
 
 void
@@ -126,6 +126,22 @@ private:
     // Used in executeUntil() to compute the number of samples to generate.
     double dmaCycleCounter1 = 0;
     double dmaCycleCounter2 = 0;
+
+
+    //
+    // Audio tap
+    //
+
+private:
+
+    /* Copy of all written samples (interleaved stereo, 16 bit).
+     * The tap is used to record audio independently of the ringbuffer which
+     * is drained by the audio API.
+     */
+    vector<int16_t> tap;
+
+    // Indicates if samples are copied into the tap
+    bool tapEnabled = false;
     
     //
     // Constructing and destructing
@@ -241,6 +257,10 @@ public:
     float ringbufferDataL(size_t offset);
     float ringbufferDataR(size_t offset);
     float ringbufferData(size_t offset);
+
+    // Reads a single audio sample at an absolute ringbuffer position
+    float getSampleL(uint32_t pos) { return ringBufferL[pos % bufferSize]; }
+    float getSampleR(uint32_t pos) { return ringBufferR[pos % bufferSize]; }
     
     /* Reads a certain amount of samples from ringbuffer
      * Samples are stored in a single mono stream
@@ -260,6 +280,12 @@ public:
     /* Writes a stereo sample into the ringbuffer
      */
     void writeData(short left, short right);
+
+    // Enables or disables the audio tap
+    void setTap(bool value) { tapEnabled = value; tap.clear(); }
+
+    // Moves all samples recorded in the tap into the provided vector
+    void drainTap(vector<int16_t> &samples) { samples.swap(tap); tap.clear(); }
     
     /* Handles a buffer underflow condition.
      * A buffer underflow occurs when the computer's audio device needs sound
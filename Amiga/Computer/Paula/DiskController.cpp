@@ -254,6 +254,9 @@ DiskController::pokeDSKLEN(uint16_t newDskLen)
     // Determine if a FIFO buffer should be emulated
     useFifo = config.useFifo;
     
+    // Check if the boot state should be recorded
+    if (newDskLen & 0x8000) amiga.bootCacheReached(BOOT_CACHE_DISK_DMA);
+
     // Disable DMA if the DMAEN bit (15) is zero
     if (!(newDskLen & 0x8000)) {
         debug(DSK_DEBUG, "dma = DRIVE_DMA_OFF\n");
@@ -160,7 +160,7 @@ Paula::scheduleIrq(IrqSource src, Cycle trigger, bool set)
     assert(isIrqSource(src));
     assert(agnus.slot[IRQ_SLOT].id == IRQ_CHECK);
 
-    debug(INT_DEBUG, "scheduleIrq(%d, %d, %d)\n", src, trigger, set); 
+    debug(amiga.intDebug, "scheduleIrq(%d, %d, %d)\n", src, trigger, set); 
 
     // If the trigger cycle is 0, we service the request immediately
     if (trigger == 0) {
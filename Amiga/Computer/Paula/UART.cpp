@@ -136,8 +136,6 @@ UART::copyToTransmitShiftRegister()
 void
 UART::copyFromReceiveShiftRegister()
 {
-    static int count = 0;
-
     debug(SER_DEBUG, "Copying %X into receive buffer\n", receiveShiftReg);
 
     stats.reads++;
@@ -150,8 +148,6 @@ UART::copyFromReceiveShiftRegister()
 
     // plainmsg("receiveBuffer: %X ('%c')\n", receiveBuffer & 0xFF, receiveBuffer & 0xFF);
 
-    count++;
-
     // Update the overrun bit
     // Bit will be 1 if the RBF interrupt hasn't been acknowledged yet
     ovrun = GET_BIT(paula.intreq, 11);
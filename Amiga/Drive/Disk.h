@@ -125,6 +125,9 @@ public:
     void setWriteProtection(bool value) { writeProtected = value; }
     
     bool isModified() { return modified; }
+
+    // Computes a hash value over the disk contents and write protection state
+    uint64_t fingerprint() { return fnv_1a_it64(fnv_1a_64(data.raw, diskSize), writeProtected); }
     void setModified(bool value) { modified = value; }
     
     
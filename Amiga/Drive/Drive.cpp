@@ -115,6 +115,7 @@ Drive::_save(uint8_t *buffer)
 
     // Write own state
     applyToPersistentItems(writer);
+    if (maskConfig) memset(buffer, 0, writer.ptr - buffer);
     applyToResetItems(writer);
 
     // Indicate whether this drive has a disk is inserted
@@ -155,10 +155,20 @@ void
 Snapshot::takeScreenshot(Amiga *amiga)
 {
     SnapshotHeader *header = (SnapshotHeader *)data;
-    
-    uint32_t *source = (uint32_t *)amiga->denise.pixelEngine.getStableLongFrame().data;
+    PixelEngine &pixelEngine = amiga->denise.pixelEngine;
+    vector<int32_t> expanded;
+
+    uint32_t *source = (uint32_t *)pixelEngine.getLatestLongFrame().data;
     uint32_t *target = header->screenshot.screen;
 
+    // In indexed mode, the frame buffer is not written (convert the frame)
+    if (pixelEngine.getFrameOutput() == FRAME_OUTPUT_INDEXED) {
+
+        expanded.resize(PIXELS);
+        pixelEngine.expandFrame(pixelEngine.getLatestIndexedLongFrame(), expanded.data());
+        source = (uint32_t *)expanded.data();
+    }
+
     // Texture cutout and scaling factors
     unsigned dx = 4;
     unsigned dy = 2;
@@ -45,7 +45,9 @@ class AmigaObject {
     //
     
     public:
-    
+
+    virtual ~AmigaObject() { }
+
     // Getter and setter for the textual description.
     const char *getDescription() const { return description ? description : ""; }
     void setDescription(const char *str) { description = strdup(str); }
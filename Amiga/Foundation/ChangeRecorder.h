@@ -116,6 +116,16 @@ template <uint16_t capacity> struct ChangeRecorder
     // Deletes all elements
     void clear() { r = w = 0; }
 
+    // Computes a fingerprint of all stored elements
+    uint64_t fingerprint(uint64_t hash)
+    {
+        for (int i = r; i != w; i = next(i)) {
+            hash = fnv_1a_it64(hash, change[i].trigger);
+            hash = fnv_1a_it64(hash, ((uint64_t)change[i].addr << 16) | change[i].value);
+        }
+        return hash;
+    }
+
     // Prints some debug info
     void dump()
     {
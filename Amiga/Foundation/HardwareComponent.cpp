@@ -9,6 +9,8 @@
 
 #include "Amiga.h"
 
+thread_local bool HardwareComponent::maskConfig = false;
+
 HardwareComponent::HardwareComponent()
 {
     pthread_mutex_init(&lock, NULL);
@@ -262,3 +264,13 @@ HardwareComponent::save(uint8_t *buffer)
 
     return ptr - buffer;
 }
+
+size_t
+HardwareComponent::saveMasked(uint8_t *buffer)
+{
+    maskConfig = true;
+    size_t result = save(buffer);
+    maskConfig = false;
+
+    return result;
+}
@@ -50,6 +50,11 @@ protected:
     // Indicates if this component should run in warp mode
     bool warp = false;
 
+    /* Indicates if configuration items are zeroed out while saving
+     * This flag is set by saveMasked() for the duration of the call.
+     */
+    static thread_local bool maskConfig;
+
 
     //
     // Constructing and destructing
@@ -220,6 +225,12 @@ public:
     size_t save(uint8_t *buffer);
     virtual size_t _save(uint8_t *buffer) = 0;
 
+    /* Saves the internal state with all configuration items zeroed out.
+     * The result is not a valid snapshot. It is used to compare the states of
+     * two emulator instances that are configured differently.
+     */
+    size_t saveMasked(uint8_t *buffer);
+
     /* Delegation methods called inside save()
      * A component can override this method to add custom behavior if not all
      * elements can be processed by the default implementation.
@@ -253,6 +264,7 @@ return reader.ptr - buffer;
 #define SAVE_SNAPSHOT_ITEMS \
 SerWriter writer(buffer); \
 applyToPersistentItems(writer); \
+if (maskConfig) memset(buffer, 0, writer.ptr - buffer); \
 applyToResetItems(writer); \
 debug(SNAP_DEBUG, "Serialized to %d bytes\n", writer.ptr - buffer); \
 return writer.ptr - buffer;
@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _SPSC_QUEUE_INC
+#define _SPSC_QUEUE_INC
+
+#include <atomic>
+
+/* A bounded, lock-free single-producer single-consumer queue
+ *
+ * The queue holds up to (capacity - 1) elements which are written in place.
+ * The producer obtains a free slot with back(), fills it, and commits it with
+ * push(). The consumer obtains the oldest element with front() and releases
+ * it with pop(). back() and front() return NULL if the queue is full or empty,
+ * respectively.
+ */
+template <class T, int capacity> class SPSCQueue
+{
+    // Ringbuffer elements
+    T elements[capacity];
+
+    // Ringbuffer read pointer (written by the consumer)
+    std::atomic<int> r { 0 };
+
+    // Ringbuffer write pointer (written by the producer)
+    std::atomic<int> w { 0 };
+
+    static int next(int i) { return (i + 1) % capacity; }
+
+public:
+
+    // Indicates if the buffer is empty or full
+    bool isEmpty() const {
+        return r.load(std::memory_order_acquire) == w.load(std::memory_order_acquire);
+    }
+    bool isFull() const {
+        return next(w.load(std::memory_order_acquire)) == r.load(std::memory_order_acquire);
+    }
+
+    // Returns the number of stored elements
+    int count() const {
+        return (capacity + w.load(std::memory_order_acquire) - r.load(std::memory_order_acquire)) % capacity;
+    }
+
+    // Producer side
+    T *back() { return isFull() ? NULL : &elements[w.load(std::memory_order_relaxed)]; }
+    void push() { w.store(next(w.load(std::memory_order_relaxed)), std::memory_order_release); }
+
+    // Consumer side
+    T *front() { return isEmpty() ? NULL : &elements[r.load(std::memory_order_relaxed)]; }
+    void pop() { r.store(next(r.load(std::memory_order_relaxed)), std::memory_order_release); }
+};
+
+#endif
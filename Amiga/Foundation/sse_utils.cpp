@@ -9,7 +9,13 @@
 
 #include "sse_utils.h"
 
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
 #include <x86intrin.h>
+#endif
+
+#if defined(__SSSE3__)
 
 void transposeSSE(uint16_t *source, uint8_t* target)
 {
@@ -40,3 +46,62 @@ void transposeSSE(uint16_t *source, uint8_t* target)
     // Read the result back from the SSE registers
     _mm_store_si128((__m128i *)target, shuffled);
 }
+
+#endif
+
+#if !defined(__SSE2__)
+
+/* Spreads the bits of a byte over the bytes of a 64 bit value. The most
+ * significant bit ends up in the least significant byte (i.e., the first
+ * byte in memory on little endian machines).
+ */
+static inline uint64_t
+spread8(uint8_t b)
+{
+    uint64_t x = (b * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+    return ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+}
+
+#endif
+
+void planarToChunky(const uint16_t planes[6], uint8_t *chunky)
+{
+#if defined(__SSE2__)
+
+    // Split the data words into their high bytes (pixels 0 - 7) and their
+    // low bytes (pixels 8 - 15)
+    // 0.hi 1.hi 2.hi ... 5.hi 0 0 0.lo 1.lo 2.lo ... 5.lo 0 0
+    
+    __m128i rows = _mm_setr_epi16(planes[0], planes[1], planes[2],
+                                  planes[3], planes[4], planes[5], 0, 0);
+    __m128i mask = _mm_set1_epi16(0xFF);
+    __m128i bytes = _mm_packus_epi16(_mm_srli_epi16(rows, 8),
+                                     _mm_and_si128(rows, mask));
+    
+    // Collect the bit slices. Slice i contains pixel i in the low byte and
+    // pixel i + 8 in the high byte
+    
+    union { uint16_t slice[8]; __m128i sse; } result;
+    for (unsigned i = 0; i < 8; i++) {
+        result.slice[i] = (uint16_t)_mm_movemask_epi8(bytes);
+        bytes = _mm_add_epi8(bytes, bytes);
+    }
+    
+    // Rearrange to pixel 0 ... pixel 15
+    
+    __m128i pixels = _mm_packus_epi16(_mm_and_si128(result.sse, mask),
+                                      _mm_srli_epi16(result.sse, 8));
+    _mm_storeu_si128((__m128i *)chunky, pixels);
+    
+#else
+    
+    uint64_t left = 0, right = 0;
+    for (unsigned i = 0; i < 6; i++) {
+        left |= spread8(planes[i] >> 8) << i;
+        right |= spread8(planes[i] & 0xFF) << i;
+    }
+    memcpy(chunky, &left, 8);
+    memcpy(chunky + 8, &right, 8);
+    
+#endif
+}
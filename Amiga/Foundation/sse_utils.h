@@ -32,6 +32,21 @@
  *                                        v
  *              Output: 31, 7, 11, 3, 13, 5, 9, 17, 30, 6, 10, 2, 12, 4, 8, 16
  */
+#if defined(__SSSE3__)
 void transposeSSE(uint16_t p[8], uint8_t* result);
+#endif
+
+/* Converts 16 pixels of planar bitplane data into chunky format
+ *
+ *     Input:   A pointer to an uint16_t[6] array.
+ *              Each array element stores the data word of a single bitplane.
+ *              The most significant bit belongs to the leftmost pixel.
+ *     Output:  A pointer to an uint8_t[16] array.
+ *              Bit n of element i is bit (15 - i) of the n-th data word.
+ *
+ * The function uses SSE2 if available and falls back to a portable
+ * multiply-and-mask implementation otherwise.
+ */
+void planarToChunky(const uint16_t planes[6], uint8_t *chunky);
 
 #endif
@@ -31,13 +31,12 @@
 // #define INITIAL_BREAKPOINT 0x068440
 
 // Register debugging (set to 1 to generate debug output)
+// OCS, CIA, and interrupt debug levels are adjustable per instance (Amiga.h)
 
-extern int OCSREG_DEBUG;  // General OCS register debugging
 static const int ECSREG_DEBUG  = 2;  // Special ECS register debugging
 static const int BLTREG_DEBUG  = 2;  // Blitter registers
 static const int INTREG_DEBUG  = 2;  // Interrupt registers
 static const int DSKREG_DEBUG  = 2;  // Disk controller registers
-extern int CIAREG_DEBUG;  // CIA registers
 static const int BPLREG_DEBUG  = 2;  // Bitplane registers
 static const int SPRREG_DEBUG  = 2;  // Sprite registers
 static const int AUDREG_DEBUG  = 2;  // Audio registers
@@ -49,7 +48,6 @@ static const int INVREG_DEBUG  = 2;  // Ivalid register accesses
 
 static const int RUNLOOP_DEBUG = 2;  // Run loop of the emulator thread
 static const int CPU_DEBUG     = 2;  // CPU
-extern int INT_DEBUG;  // Interrupts
 static const int CIA_DEBUG     = 2;  // CIAs
 static const int TOD_DEBUG     = 2;  // TODs (CIA 24-bit counters)
 static const int RTC_DEBUG     = 2;  // Real-time clock
@@ -0,0 +1,137 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "AmigaFarm.h"
+
+AmigaFarm::AmigaFarm()
+{
+    setDescription("AmigaFarm");
+}
+
+AmigaFarm::~AmigaFarm()
+{
+    for (FarmJob &job : jobs) free((void *)job.disk);
+    if (rom) free((void *)rom);
+}
+
+void
+AmigaFarm::setRom(const char *path)
+{
+    assert(path != NULL);
+
+    if (rom) free((void *)rom);
+    rom = strdup(path);
+}
+
+void
+AmigaFarm::configure(ConfigOption option, long value)
+{
+    options.push_back(std::make_pair(option, value));
+}
+
+void
+AmigaFarm::addJob(const char *disk, long frames)
+{
+    FarmJob job;
+    memset(&job, 0, sizeof(job));
+
+    job.disk = disk ? strdup(disk) : NULL;
+    job.frames = frames;
+
+    jobs.push_back(job);
+}
+
+unsigned
+AmigaFarm::run(unsigned threads)
+{
+    runWorkers(threads, jobs.size());
+
+    unsigned failed = 0;
+    for (FarmJob &job : jobs) if (!job.done) failed++;
+    return failed;
+}
+
+void
+AmigaFarm::workerLoop()
+{
+    Amiga *amiga = createInstance();
+    size_t nr;
+
+    while (claimJob(nr)) {
+
+        if (amiga) {
+            runJob(amiga, jobs[nr]);
+        } else {
+            jobs[nr].error = "Cannot create emulator instance";
+        }
+    }
+
+    if (amiga) delete amiga;
+}
+
+Amiga *
+AmigaFarm::createInstance()
+{
+    Amiga *amiga = new Amiga();
+
+    if (!rom || !amiga->mem.loadRomFromFile(rom)) {
+        warn("Cannot load Rom %s\n", rom ? rom : "(none)");
+        delete amiga;
+        return NULL;
+    }
+
+    // Start with a standard Amiga 500 and apply the farm's configuration
+    amiga->configure(VA_CHIP_RAM, 512);
+    for (auto &option : options) {
+        amiga->configure(option.first, option.second);
+    }
+
+    if (!amiga->readyToPowerUp()) {
+        delete amiga;
+        return NULL;
+    }
+
+    amiga->setBootCache(bootCache);
+
+    return amiga;
+}
+
+void
+AmigaFarm::runJob(Amiga *amiga, FarmJob &job)
+{
+    job.done = false;
+    job.error = NULL;
+
+    // Cold-start the emulator
+    amiga->powerOff();
+    if (amiga->df0.hasDisk()) amiga->df0.ejectDisk();
+
+    if (job.disk) {
+
+        ADFFile *adf = ADFFile::makeWithFile(job.disk);
+        if (!adf) {
+            job.error = "Cannot read disk image";
+            return;
+        }
+        amiga->df0.insertDisk(Disk::makeWithFile(adf));
+        delete adf;
+    }
+
+    amiga->powerOn();
+    amiga->warpOn();
+
+    for (long i = 0; i < job.frames; i++) amiga->executeFrame();
+
+    job.stateHash = amiga->stateHash();
+    job.frameHash = amiga->frameHash();
+    job.done = true;
+
+    if (callback) callback(userData, &job, amiga);
+}
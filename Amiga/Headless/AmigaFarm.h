@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _AMIGA_FARM_INC
+#define _AMIGA_FARM_INC
+
+#include "WorkerPool.h"
+#include "AmigaTypes.h"
+
+class Amiga;
+class BootCache;
+
+// A single job processed by the farm
+typedef struct {
+
+    // Disk image inserted into df0 (NULL if the Amiga boots without a disk)
+    const char *disk;
+
+    // Number of frames to emulate
+    long frames;
+
+    // Indicates if the job has been executed successfully
+    bool done;
+
+    // Error message if the job could not be executed (NULL if none)
+    const char *error;
+
+    // State hash and frame buffer hash after the last emulated frame
+    uint64_t stateHash;
+    uint64_t frameHash;
+
+} FarmJob;
+
+/* Callback invoked by a worker thread after a job has been processed.
+ * It is executed inside the worker thread and has exclusive access to the
+ * emulator instance, e.g., for taking a screenshot or inspecting memory.
+ */
+typedef void FarmCallback(void *userData, FarmJob *job, Amiga *amiga);
+
+/* The Amiga farm runs many emulator instances in parallel without a GUI.
+ * It manages a pool of worker threads, each owning a single emulator
+ * instance. A worker picks up the next pending job, cold-starts its Amiga
+ * with the job's disk inserted, emulates the requested number of frames in
+ * warp mode, and records the resulting hash values. All instances share the
+ * same Kickstart Rom and configuration.
+ */
+class AmigaFarm : public WorkerPool {
+
+    // Path to the Kickstart Rom used by all instances
+    const char *rom = NULL;
+
+    // Configuration options applied to all instances
+    vector<pair<ConfigOption,long>> options;
+
+    // All registered jobs
+    vector<FarmJob> jobs;
+
+    // Optional boot cache shared by all instances
+    BootCache *bootCache = NULL;
+
+    // Optional callback invoked when a job has been processed
+    FarmCallback *callback = NULL;
+    void *userData = NULL;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    AmigaFarm();
+    ~AmigaFarm();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    // Sets the Kickstart Rom used by all instances
+    void setRom(const char *path);
+
+    // Registers a configuration option applied to all instances
+    void configure(ConfigOption option, long value);
+
+    // Registers a job
+    void addJob(const char *disk, long frames);
+
+    // Attaches a boot cache to all instances
+    void setBootCache(BootCache *cache) { bootCache = cache; }
+
+    // Registers a callback invoked after each job
+    void setCallback(FarmCallback *func, void *data) { callback = func; userData = data; }
+
+
+    //
+    // Running jobs
+    //
+
+public:
+
+    /* Executes all registered jobs using the specified number of threads.
+     * Returns the number of jobs that could not be executed.
+     */
+    unsigned run(unsigned threads);
+
+    // Returns the results of the most recent run
+    vector<FarmJob> &getJobs() { return jobs; }
+
+    // Creates an emulator instance and processes jobs until all jobs are done
+    void workerLoop() override;
+
+private:
+
+    // Creates and configures an emulator instance
+    Amiga *createInstance();
+
+    // Executes a single job
+    void runJob(Amiga *amiga, FarmJob &job);
+};
+
+#endif
@@ -0,0 +1,147 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "BootCache.h"
+
+BootCache::BootCache()
+{
+    setDescription("BootCache");
+
+    pthread_mutex_init(&lock, NULL);
+}
+
+BootCache::~BootCache()
+{
+    clear();
+    pthread_mutex_destroy(&lock);
+}
+
+uint64_t
+BootCache::computeKey(Amiga &amiga)
+{
+    AmigaConfiguration config = amiga.getConfig();
+    uint64_t hash = fnv_1a_init64();
+
+    // Roms
+    hash = fnv_1a_it64(hash, amiga.mem.romFingerprint());
+    hash = fnv_1a_it64(hash, amiga.mem.hasExt() ? amiga.mem.extFingerprint() : 0);
+
+    // Memory layout
+    hash = fnv_1a_it64(hash, config.mem.chipSize);
+    hash = fnv_1a_it64(hash, config.mem.slowSize);
+    hash = fnv_1a_it64(hash, config.mem.fastSize);
+    hash = fnv_1a_it64(hash, config.mem.romSize);
+    hash = fnv_1a_it64(hash, config.mem.womSize);
+    hash = fnv_1a_it64(hash, config.mem.extSize);
+    hash = fnv_1a_it64(hash, config.mem.extStart);
+
+    // Chipset
+    hash = fnv_1a_it64(hash, config.agnus.revision);
+    hash = fnv_1a_it64(hash, config.denise.revision);
+    hash = fnv_1a_it64(hash, config.rtc.model);
+    hash = fnv_1a_it64(hash, config.blitter.accuracy);
+    hash = fnv_1a_it64(hash, config.blitter.parallel);
+    hash = fnv_1a_it64(hash, config.copper.precompute);
+
+    // Sprites and collision detection
+    hash = fnv_1a_it64(hash, config.denise.emulateSprites);
+    hash = fnv_1a_it64(hash, config.denise.clxSprSpr);
+    hash = fnv_1a_it64(hash, config.denise.clxSprPlf);
+    hash = fnv_1a_it64(hash, config.denise.clxPlfPlf);
+
+    // Audio filter
+    hash = fnv_1a_it64(hash, config.audio.filterActivation);
+    hash = fnv_1a_it64(hash, config.audio.filterType);
+
+    // Peripherals
+    hash = fnv_1a_it64(hash, config.serialPort.device);
+    hash = fnv_1a_it64(hash, amiga.keyboard.layout);
+
+    // Drives and disks
+    hash = fnv_1a_it64(hash, config.diskController.useFifo);
+    for (int i = 0; i < 4; i++) {
+
+        Drive *drive = amiga.df[i];
+        DriveConfig driveConfig = drive->getConfig();
+
+        hash = fnv_1a_it64(hash, config.diskController.connected[i]);
+        hash = fnv_1a_it64(hash, driveConfig.type);
+        hash = fnv_1a_it64(hash, driveConfig.speed);
+        hash = fnv_1a_it64(hash, drive->hasDisk());
+
+        if (drive->hasDisk()) {
+
+            hash = fnv_1a_it64(hash, drive->disk->getType());
+            hash = fnv_1a_it64(hash, drive->disk->isWriteProtected());
+
+            // Disk data is only read after the first disk DMA
+            if (point != BOOT_CACHE_DISK_DMA) {
+                hash = fnv_1a_it64(hash, drive->disk->fingerprint());
+            }
+        }
+    }
+
+    return hash;
+}
+
+Snapshot *
+BootCache::lookup(uint64_t key)
+{
+    Snapshot *result = NULL;
+
+    pthread_mutex_lock(&lock);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) result = it->second;
+
+    pthread_mutex_unlock(&lock);
+
+    return result;
+}
+
+void
+BootCache::store(uint64_t key, Snapshot *snapshot)
+{
+    assert(snapshot != NULL);
+
+    pthread_mutex_lock(&lock);
+
+    if (entries.find(key) == entries.end()) {
+
+        debug("Caching boot state %016llx\n", (unsigned long long)key);
+        entries[key] = snapshot;
+
+    } else {
+        delete snapshot;
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+size_t
+BootCache::count()
+{
+    pthread_mutex_lock(&lock);
+    size_t result = entries.size();
+    pthread_mutex_unlock(&lock);
+
+    return result;
+}
+
+void
+BootCache::clear()
+{
+    pthread_mutex_lock(&lock);
+
+    for (auto &entry : entries) delete entry.second;
+    entries.clear();
+
+    pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,116 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _BOOT_CACHE_INC
+#define _BOOT_CACHE_INC
+
+#include "AmigaObject.h"
+
+class Amiga;
+class Snapshot;
+
+// Point in time when the boot state is recorded
+typedef enum
+{
+    BOOT_CACHE_FRAME,    // When a certain frame has been reached
+    BOOT_CACHE_DISK_DMA  // When DSKLEN is written with the DMAEN bit set
+}
+BootCachePoint;
+
+inline bool isBootCachePoint(long value)
+{
+    return value >= BOOT_CACHE_FRAME && value <= BOOT_CACHE_DISK_DMA;
+}
+
+/* The boot cache stores the state of an Amiga at a certain point of the
+ * Kickstart boot process. When an Amiga with an attached boot cache is
+ * powered on, it looks up a snapshot that has been recorded with an
+ * identical configuration and restores it. If no such snapshot exists, the
+ * Amiga records one as soon as the configured point in time is reached.
+ * This skips the memory test, autoconfig, and the boot block wait on all
+ * subsequent power-ups.
+ *
+ * Snapshots are keyed by a hash over the Rom fingerprints, all configuration
+ * items stored in a snapshot, and the kind of all inserted disks. Hence,
+ * restoring a boot state never changes the configuration of an Amiga. If
+ * the boot state is recorded at the first disk DMA, no disk data has been
+ * read yet. In this case, the disk contents are not part of the key and the
+ * disks inserted by the restoring instance are kept. If the boot state is recorded at a
+ * certain frame, the disk contents are part of the key, too. The cache is
+ * thread-safe and can be shared among multiple emulator instances.
+ */
+class BootCache : public AmigaObject {
+
+    // Recorded boot states
+    map<uint64_t, Snapshot *> entries;
+
+    // Protects the entries
+    pthread_mutex_t lock;
+
+    // Point in time when the boot state is recorded
+    BootCachePoint point = BOOT_CACHE_DISK_DMA;
+
+    // Frame number used if point equals BOOT_CACHE_FRAME
+    long frame = 250;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    BootCache();
+    ~BootCache();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    BootCachePoint getPoint() { return point; }
+    void setPoint(BootCachePoint value) { assert(isBootCachePoint(value)); point = value; }
+
+    long getFrame() { return frame; }
+    void setFrame(long value) { frame = value; }
+
+
+    //
+    // Managing entries
+    //
+
+public:
+
+    // Computes the lookup key for the current configuration of an Amiga
+    uint64_t computeKey(Amiga &amiga);
+
+    /* Looks up a recorded boot state.
+     * Returns NULL if no entry exists. The returned snapshot is owned by the
+     * cache and must not be deleted by the caller.
+     */
+    Snapshot *lookup(uint64_t key);
+
+    /* Adds a boot state to the cache.
+     * The cache takes ownership of the snapshot. If an entry with the same key
+     * already exists, the provided snapshot is deleted.
+     */
+    void store(uint64_t key, Snapshot *snapshot);
+
+    // Returns the number of recorded boot states
+    size_t count();
+
+    /* Deletes all recorded boot states.
+     * Must not be called while an instance using the cache is powering on.
+     */
+    void clear();
+};
+
+#endif
@@ -0,0 +1,438 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "Capture.h"
+
+static void *
+writerThreadMain(void *capture)
+{
+    ((Capture *)capture)->writerLoop();
+    return NULL;
+}
+
+Capture::Capture()
+{
+    setDescription("Capture");
+
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+Capture::~Capture()
+{
+    stop();
+
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+bool
+Capture::start(Amiga *amiga, const char *path, CaptureFormat format)
+{
+    assert(amiga != NULL);
+    assert(path != NULL);
+    assert(isCaptureFormat(format));
+
+    if (isRecording()) stop();
+
+    char *name = new char[strlen(path) + 16];
+
+    // Create the output files
+    if (format == CAPTURE_Y4M) {
+
+        sprintf(name, "%s.y4m", path);
+        if (!(video = fopen(name, "wb"))) {
+            warn("Cannot create %s\n", name);
+            delete [] name;
+            return false;
+        }
+        fprintf(video, "YUV4MPEG2 W%d H%d F50:1 Ip A1:1 C444\n", width, height);
+    }
+
+    if (audio) {
+
+        sprintf(name, "%s.wav", path);
+        if (!(wav = fopen(name, "wb"))) {
+            warn("Cannot create %s\n", name);
+            if (video) { fclose(video); video = NULL; }
+            delete [] name;
+            return false;
+        }
+        wavRate = (uint32_t)amiga->paula.audioUnit.getSampleRate();
+        wavBytes = 0;
+        writeWavHeader();
+    }
+
+    delete [] name;
+
+    this->path = strdup(path);
+    this->format = format;
+
+    pendingRepeats = 0;
+    recordedFrames = 0;
+    droppedFrames = 0;
+    writtenFrames = 0;
+
+    // Launch the writer thread
+    writerExit = false;
+    pthread_create(&writer, NULL, writerThreadMain, (void *)this);
+
+    // Attach to the emulator
+    amiga->suspend();
+    amiga->paula.audioUnit.setTap(audio);
+    amiga->setCapture(this);
+    this->amiga = amiga;
+    amiga->resume();
+
+    return true;
+}
+
+void
+Capture::stop()
+{
+    if (!isRecording()) return;
+
+    // Detach from the emulator
+    amiga->suspend();
+    amiga->setCapture(NULL);
+    amiga->paula.audioUnit.setTap(false);
+    amiga->resume();
+    amiga = NULL;
+
+    // Let the writer thread process all pending frames and terminate
+    pthread_mutex_lock(&lock);
+    writerExit = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+
+    // Close the output files
+    if (video) {
+        fclose(video);
+        video = NULL;
+    }
+    if (wav) {
+        writeWavHeader();
+        fclose(wav);
+        wav = NULL;
+    }
+
+    free(path);
+    path = NULL;
+
+    debug("Recorded %ld frames (%ld dropped)\n", recordedFrames, droppedFrames);
+}
+
+void
+Capture::recordFrame(ScreenBuffer *buffer, IndexedFrame *indexed)
+{
+    assert(isRecording());
+
+    CaptureJob *job = queue.back();
+
+    if (job == NULL) {
+
+        // Drop the frame in real-time mode and keep the audio samples
+        if (!amiga->getWarp()) {
+            pendingRepeats++;
+            droppedFrames++;
+            return;
+        }
+
+        // Wait for the writer thread in warp mode
+        pthread_mutex_lock(&lock);
+        emulatorWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (queue.isFull()) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        emulatorWaiting = false;
+        pthread_mutex_unlock(&lock);
+
+        job = queue.back();
+        assert(job != NULL);
+    }
+
+    // Copy the frame and the audio samples
+    job->pixels.resize(width * height);
+    crop(buffer, indexed, job->pixels.data());
+    job->repeats = pendingRepeats;
+    job->samples.clear();
+    if (audio) amiga->paula.audioUnit.drainTap(job->samples);
+
+    pendingRepeats = 0;
+    recordedFrames++;
+
+    queue.push();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Wake up the writer thread if it is sleeping
+    if (writerWaiting) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+void
+Capture::crop(ScreenBuffer *buffer, IndexedFrame *indexed, uint32_t *dst)
+{
+    PixelEngine &pixelEngine = amiga->denise.pixelEngine;
+    int32_t expanded[2][HPIXELS];
+
+    /* The visible area of a line starts behind the HBLANK area and reaches
+     * into the first pixels of the next line (see Snapshot::takeScreenshot).
+     */
+    int xStart = 4 * HBLANK_MAX;
+    int head = HPIXELS - xStart;
+    int tail = width - head;
+
+    for (int y = VBLANK_CNT; y < VPIXELS; y++, dst += width) {
+
+        const int32_t *line = buffer->data + y * HPIXELS;
+        const int32_t *next = buffer->data + (y + 1) * HPIXELS;
+
+        // Convert indexed lines to RGBA first
+        if (indexed) {
+            if (y == VBLANK_CNT) pixelEngine.expandLine(indexed, y, expanded[y % 2]);
+            if (y + 1 < VPIXELS) pixelEngine.expandLine(indexed, y + 1, expanded[(y + 1) % 2]);
+            line = expanded[y % 2];
+            next = expanded[(y + 1) % 2];
+        }
+
+        memcpy(dst, line + xStart, head * sizeof(uint32_t));
+
+        if (y + 1 < VPIXELS) {
+            memcpy(dst + head, next, tail * sizeof(uint32_t));
+        } else {
+            memset(dst + head, 0, tail * sizeof(uint32_t));
+        }
+    }
+}
+
+void
+Capture::writerLoop()
+{
+    while (1) {
+
+        CaptureJob *job = queue.front();
+
+        // Sleep if there is nothing to do
+        if (job == NULL) {
+
+            pthread_mutex_lock(&lock);
+            writerWaiting = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (queue.isEmpty() && !writerExit) {
+                pthread_cond_wait(&cond, &lock);
+            }
+            writerWaiting = false;
+            pthread_mutex_unlock(&lock);
+
+            if (queue.isEmpty() && writerExit) break;
+            continue;
+        }
+
+        // Write the frame (and duplicates for all dropped frames)
+        for (long i = 0; i <= job->repeats; i++) {
+
+            if (format == CAPTURE_Y4M) writeY4M(job->pixels.data());
+            if (format == CAPTURE_PNG) writePNG(job->pixels.data());
+            writtenFrames++;
+        }
+
+        // Write the audio samples
+        if (wav && !job->samples.empty()) {
+
+            size_t count = job->samples.size();
+            fwrite(job->samples.data(), sizeof(int16_t), count, wav);
+            wavBytes += (uint32_t)(count * sizeof(int16_t));
+        }
+
+        queue.pop();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Wake up the emulator thread if it is waiting for a free slot
+        if (emulatorWaiting) {
+            pthread_mutex_lock(&lock);
+            pthread_cond_broadcast(&cond);
+            pthread_mutex_unlock(&lock);
+        }
+    }
+}
+
+void
+Capture::writeY4M(const uint32_t *pixels)
+{
+    const size_t size = width * height;
+
+    scratch.resize(3 * size);
+    uint8_t *y = scratch.data();
+    uint8_t *u = y + size;
+    uint8_t *v = u + size;
+
+    // Convert to YCbCr (ITU-R BT.601, studio range)
+    for (size_t i = 0; i < size; i++) {
+
+        int r = pixels[i] & 0xFF;
+        int g = (pixels[i] >> 8) & 0xFF;
+        int b = (pixels[i] >> 16) & 0xFF;
+
+        y[i] = (uint8_t)((( 66 * r + 129 * g +  25 * b + 128) >> 8) + 16);
+        u[i] = (uint8_t)(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = (uint8_t)(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+    }
+
+    fputs("FRAME\n", video);
+    fwrite(scratch.data(), 1, scratch.size(), video);
+}
+
+void
+Capture::writePNG(const uint32_t *pixels)
+{
+    const size_t rowSize = 1 + 3 * width;
+    const size_t rawSize = rowSize * height;
+
+    // Convert to RGB rows, each one preceded by filter type 0 (none)
+    scratch.resize(rawSize);
+    uint8_t *p = scratch.data();
+
+    for (int y = 0; y < height; y++) {
+
+        *p++ = 0;
+        for (int x = 0; x < width; x++) {
+
+            uint32_t color = *pixels++;
+            *p++ = color & 0xFF;
+            *p++ = (color >> 8) & 0xFF;
+            *p++ = (color >> 16) & 0xFF;
+        }
+    }
+
+    /* Wrap the image data into a zlib stream made of uncompressed deflate
+     * blocks. Compression is left to external tools, because it would slow
+     * down the writer thread considerably.
+     */
+    vector<uint8_t> zlib;
+    zlib.reserve(rawSize + rawSize / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < rawSize; ) {
+
+        size_t len = MIN(rawSize - offset, (size_t)65535);
+        bool last = offset + len == rawSize;
+
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(len & 0xFF);
+        zlib.push_back(len >> 8);
+        zlib.push_back(~len & 0xFF);
+        zlib.push_back((~len >> 8) & 0xFF);
+        zlib.insert(zlib.end(), scratch.begin() + offset, scratch.begin() + offset + len);
+
+        for (size_t i = offset; i < offset + len; i++) {
+            a = (a + scratch[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        offset += len;
+    }
+
+    uint32_t adler = (b << 16) | a;
+    zlib.push_back(adler >> 24);
+    zlib.push_back((adler >> 16) & 0xFF);
+    zlib.push_back((adler >> 8) & 0xFF);
+    zlib.push_back(adler & 0xFF);
+
+    // Assemble the file
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t header[13] = {
+        (uint8_t)(width >> 24), (uint8_t)(width >> 16), (uint8_t)(width >> 8), (uint8_t)width,
+        (uint8_t)(height >> 24), (uint8_t)(height >> 16), (uint8_t)(height >> 8), (uint8_t)height,
+        8, 2, 0, 0, 0 // 8 bit RGB, no interlace
+    };
+
+    vector<uint8_t> png(signature, signature + 8);
+    appendChunk(png, "IHDR", header, sizeof(header));
+    appendChunk(png, "IDAT", zlib.data(), zlib.size());
+    appendChunk(png, "IEND", NULL, 0);
+
+    // Write the file
+    char *name = new char[strlen(path) + 16];
+    sprintf(name, "%s_%06ld.png", path, writtenFrames);
+
+    FILE *file = fopen(name, "wb");
+    if (file) {
+        fwrite(png.data(), 1, png.size(), file);
+        fclose(file);
+    } else {
+        warn("Cannot create %s\n", name);
+    }
+
+    delete [] name;
+}
+
+void
+Capture::appendChunk(vector<uint8_t> &png, const char *type,
+                     const uint8_t *data, size_t size)
+{
+    // Length
+    png.push_back((size >> 24) & 0xFF);
+    png.push_back((size >> 16) & 0xFF);
+    png.push_back((size >> 8) & 0xFF);
+    png.push_back(size & 0xFF);
+
+    // Type and data (both are covered by the checksum)
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    if (size) png.insert(png.end(), data, data + size);
+
+    // Checksum
+    uint32_t crc = crc32(png.data() + start, png.size() - start);
+    png.push_back(crc >> 24);
+    png.push_back((crc >> 16) & 0xFF);
+    png.push_back((crc >> 8) & 0xFF);
+    png.push_back(crc & 0xFF);
+}
+
+void
+Capture::writeWavHeader()
+{
+    assert(wav != NULL);
+
+    uint8_t header[44];
+    uint32_t byteRate = wavRate * 4;
+
+    auto write16 = [&](int offset, uint16_t value) {
+        header[offset] = value & 0xFF;
+        header[offset + 1] = value >> 8;
+    };
+    auto write32 = [&](int offset, uint32_t value) {
+        write16(offset, value & 0xFFFF);
+        write16(offset + 2, value >> 16);
+    };
+
+    memcpy(header, "RIFF", 4);
+    write32(4, 36 + wavBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    write32(16, 16);            // Size of the fmt chunk
+    write16(20, 1);             // PCM
+    write16(22, 2);             // Stereo
+    write32(24, wavRate);
+    write32(28, byteRate);
+    write16(32, 4);             // Block alignment
+    write16(34, 16);            // Bits per sample
+    memcpy(header + 36, "data", 4);
+    write32(40, wavBytes);
+
+    fseek(wav, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), wav);
+    fseek(wav, 0, SEEK_END);
+}
@@ -0,0 +1,189 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _CAPTURE_INC
+#define _CAPTURE_INC
+
+#include "AmigaObject.h"
+#include "DeniseTypes.h"
+#include "SPSCQueue.h"
+#include <atomic>
+
+class Amiga;
+struct IndexedFrame;
+
+// Output format of a capture
+typedef enum
+{
+    CAPTURE_Y4M,  // Uncompressed YUV 4:4:4 video stream plus a WAV file
+    CAPTURE_PNG   // One PNG file per frame plus a WAV file
+}
+CaptureFormat;
+
+inline bool isCaptureFormat(long value)
+{
+    return value >= CAPTURE_Y4M && value <= CAPTURE_PNG;
+}
+
+/* The capture records the video and audio output of an Amiga without a GUI.
+ * It is attached to a running Amiga with start() and detached with stop().
+ *
+ * At the end of each frame, the emulator thread crops the finished frame to
+ * the visible area (the same area that is used for snapshot previews) and
+ * copies it into a preallocated slot of a bounded queue, together with all
+ * audio samples produced during the frame. A writer thread encodes the queued
+ * frames and writes them to disk. Hence, the emulator thread only pays for a
+ * buffer copy per frame.
+ *
+ * If the queue is full in warp mode, the emulator thread waits for the writer
+ * thread, so that no frame is lost. In real-time mode, the frame is dropped
+ * instead. To keep audio and video in sync, a dropped frame is replaced by a
+ * duplicate of the next recorded frame.
+ */
+class Capture : public AmigaObject {
+
+public:
+
+    // Dimensions of a captured frame
+    static const int width = HPIXELS - 4 * HBLANK_MAX + 4 * HBLANK_MIN;
+    static const int height = VPIXELS - VBLANK_CNT;
+
+private:
+
+    // A recorded frame
+    struct CaptureJob {
+
+        // Cropped pixel data (RGBA)
+        vector<uint32_t> pixels;
+
+        // Number of dropped frames preceding this frame
+        long repeats = 0;
+
+        // Audio samples produced during the frame (interleaved stereo)
+        vector<int16_t> samples;
+    };
+
+    // The Amiga the capture is attached to (NULL if not recording)
+    Amiga *amiga = NULL;
+
+    // Output format
+    CaptureFormat format = CAPTURE_Y4M;
+
+    // Indicates if audio is recorded
+    bool audio = true;
+
+    // Path of the output files without the file extension
+    char *path = NULL;
+
+    // Frames waiting to be written
+    SPSCQueue<CaptureJob, 9> queue;
+
+    // The writer thread
+    pthread_t writer;
+
+    // Used to put the writer thread and the emulator thread to sleep
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    std::atomic<bool> writerWaiting { false };
+    std::atomic<bool> emulatorWaiting { false };
+    std::atomic<bool> writerExit { false };
+
+    // Number of frames dropped since the last recorded frame
+    long pendingRepeats = 0;
+
+    // Statistics
+    long recordedFrames = 0;
+    long droppedFrames = 0;
+
+    // Output files
+    FILE *video = NULL;
+    FILE *wav = NULL;
+
+    // Number of frames written so far (used to name PNG files)
+    long writtenFrames = 0;
+
+    // Sample rate and number of audio bytes of the WAV file
+    uint32_t wavRate = 0;
+    uint32_t wavBytes = 0;
+
+    // Scratch buffer used to encode a frame
+    vector<uint8_t> scratch;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    Capture();
+    ~Capture();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    bool getAudio() { return audio; }
+    void setAudio(bool value) { assert(!isRecording()); audio = value; }
+
+
+    //
+    // Recording
+    //
+
+public:
+
+    /* Starts recording. The provided path is used without file extension.
+     * Returns false if the output files could not be created.
+     */
+    bool start(Amiga *amiga, const char *path, CaptureFormat format);
+
+    // Stops recording and waits until all queued frames have been written
+    void stop();
+
+    // Indicates if a recording is in progress
+    bool isRecording() { return amiga != NULL; }
+
+    // Returns the number of recorded or dropped frames
+    long getRecordedFrames() { return recordedFrames; }
+    long getDroppedFrames() { return droppedFrames; }
+
+    /* Records a finished frame. This function is called by the emulator
+     * thread at the end of each frame. If the pixel engine runs in indexed
+     * mode, indexed points to the indexed version of the frame.
+     */
+    void recordFrame(ScreenBuffer *buffer, IndexedFrame *indexed);
+
+    /* The thread enter function.
+     * Writes queued frames until the capture is stopped. It has to be
+     * declared public to make it accessible by the writer thread.
+     */
+    void writerLoop();
+
+private:
+
+    // Copies the visible area of a frame into a job
+    void crop(ScreenBuffer *buffer, IndexedFrame *indexed, uint32_t *dst);
+
+    // Writes a single frame in the selected output format
+    void writeY4M(const uint32_t *pixels);
+    void writePNG(const uint32_t *pixels);
+
+    // Appends a PNG chunk to a memory buffer
+    void appendChunk(vector<uint8_t> &png, const char *type,
+                     const uint8_t *data, size_t size);
+
+    // Writes or updates the header of the WAV file
+    void writeWavHeader();
+};
+
+#endif
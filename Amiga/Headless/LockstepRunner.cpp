@@ -0,0 +1,219 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "LockstepRunner.h"
+
+LockstepRunner::LockstepRunner()
+{
+    setDescription("LockstepRunner");
+}
+
+LockstepRunner::~LockstepRunner()
+{
+    if (a) delete a;
+    if (b) delete b;
+}
+
+void
+LockstepRunner::configureA(ConfigOption option, long value)
+{
+    optionsA.push_back(std::make_pair(option, value));
+}
+
+void
+LockstepRunner::configureB(ConfigOption option, long value)
+{
+    optionsB.push_back(std::make_pair(option, value));
+}
+
+bool
+LockstepRunner::setup(const char *path)
+{
+    Snapshot *snapshot = Snapshot::makeWithFile(path);
+
+    if (!snapshot) {
+        warn("Cannot read snapshot %s\n", path);
+        return false;
+    }
+
+    if (a) { delete a; a = NULL; }
+    if (b) { delete b; b = NULL; }
+
+    a = launch(snapshot, optionsA);
+    b = launch(snapshot, optionsB);
+    steps = 0;
+
+    delete snapshot;
+    return a != NULL && b != NULL;
+}
+
+Amiga *
+LockstepRunner::launch(Snapshot *snapshot, vector<pair<ConfigOption,long>> &options)
+{
+    Amiga *amiga = new Amiga();
+
+    // Powering on requires a Rom which is provided by the snapshot
+    amiga->loadFromSnapshotUnsafe(snapshot);
+    amiga->powerOn();
+    amiga->loadFromSnapshotUnsafe(snapshot);
+
+    if (!amiga->isPoweredOn()) {
+        warn("Cannot power up the emulator\n");
+        delete amiga;
+        return NULL;
+    }
+
+    for (auto &option : options) {
+        amiga->configure(option.first, option.second);
+    }
+
+    // Record executed instructions to be able to print a trace
+    amiga->cpu.debugger.enableLogging();
+    amiga->warpOn();
+
+    return amiga;
+}
+
+long
+LockstepRunner::run(long count)
+{
+    assert(a != NULL && b != NULL);
+
+    vector<uint64_t> hashA, hashB;
+
+    for (long i = 0; i < count; i++, steps++) {
+
+        step(a);
+        step(b);
+
+        hash(a, hashA);
+        hash(b, hashB);
+
+        if (hashA != hashB) {
+            report(hashA, hashB);
+            return steps;
+        }
+    }
+
+    return -1;
+}
+
+void
+LockstepRunner::step(Amiga *amiga)
+{
+    if (granularity) {
+        for (long i = 0; i < granularity; i++) amiga->cpu.execute();
+    } else {
+        amiga->executeFrame();
+    }
+}
+
+void
+LockstepRunner::hash(Amiga *amiga, vector<uint64_t> &result)
+{
+    result.clear();
+
+    // Hide the options under test by masking out all configuration items
+    for (HardwareComponent *c : amiga->subComponents) {
+        result.push_back(amiga->componentHash(c, true));
+    }
+    result.push_back(amiga->frameHash());
+}
+
+void
+LockstepRunner::report(vector<uint64_t> &hashA, vector<uint64_t> &hashB)
+{
+    size_t count = a->subComponents.size();
+
+    msg("Instances diverged in step %ld\n", steps);
+    msg("Instance A: Frame %lld (%d,%d) CPU clock %lld\n",
+        (long long)a->agnus.frame, a->agnus.pos.v, a->agnus.pos.h,
+        (long long)a->cpu.getMasterClock());
+    msg("Instance B: Frame %lld (%d,%d) CPU clock %lld\n",
+        (long long)b->agnus.frame, b->agnus.pos.v, b->agnus.pos.h,
+        (long long)b->cpu.getMasterClock());
+
+    for (size_t i = 0; i < count; i++) {
+
+        if (hashA[i] == hashB[i]) continue;
+
+        HardwareComponent *ca = a->subComponents[i];
+        HardwareComponent *cb = b->subComponents[i];
+
+        msg("\n%s differs\n\n", ca->getDescription());
+
+        if (ca == &a->mem) {
+            dumpRamDifference();
+        } else {
+            msg("Instance A:\n");
+            ca->dump();
+            msg("Instance B:\n");
+            cb->dump();
+        }
+    }
+
+    if (hashA[count] != hashB[count]) {
+        msg("\nFrame buffers differ\n");
+    }
+
+    msg("\nInstance A: Most recent instructions\n\n");
+    dumpTrace(a);
+    msg("\nInstance B: Most recent instructions\n\n");
+    dumpTrace(b);
+}
+
+void
+LockstepRunner::dumpTrace(Amiga *amiga)
+{
+    CPU &cpu = amiga->cpu;
+    char instr[128], pc[16], sr[32];
+
+    int count = cpu.debugger.loggedInstructions();
+    int first = count > traceLength ? count - traceLength : 0;
+
+    for (int i = first; i < count; i++) {
+
+        moira::Registers r = cpu.debugger.logEntryAbs(i);
+        cpu.disassemble(r.pc, instr);
+        cpu.disassemblePC(r.pc, pc);
+        cpu.disassembleSR(r.sr, sr);
+        plainmsg("%s: %-32s %s\n", pc, instr, sr);
+    }
+}
+
+void
+LockstepRunner::dumpRamDifference()
+{
+    struct { const char *name; uint8_t *pa; uint8_t *pb; size_t sa; size_t sb; } ram[] = {
+
+        { "Chip Ram", a->mem.chip, b->mem.chip, a->mem.getConfig().chipSize, b->mem.getConfig().chipSize },
+        { "Slow Ram", a->mem.slow, b->mem.slow, a->mem.getConfig().slowSize, b->mem.getConfig().slowSize },
+        { "Fast Ram", a->mem.fast, b->mem.fast, a->mem.getConfig().fastSize, b->mem.getConfig().fastSize },
+        { "WOM", a->mem.wom, b->mem.wom, a->mem.getConfig().womSize, b->mem.getConfig().womSize }
+    };
+
+    for (auto &r : ram) {
+
+        if (r.sa != r.sb) {
+            msg("%s: Size mismatch (%zu vs. %zu)\n", r.name, r.sa, r.sb);
+            continue;
+        }
+
+        size_t diffs = 0, first = 0;
+        for (size_t i = 0; i < r.sa; i++) {
+            if (r.pa[i] != r.pb[i] && diffs++ == 0) first = i;
+        }
+
+        if (diffs) {
+            msg("%s: %zu bytes differ. First difference at offset %06zX (%02X vs. %02X)\n",
+                r.name, diffs, first, r.pa[first], r.pb[first]);
+        }
+    }
+}
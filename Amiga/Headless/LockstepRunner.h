@@ -0,0 +1,121 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _LOCKSTEP_RUNNER_INC
+#define _LOCKSTEP_RUNNER_INC
+
+#include "AmigaObject.h"
+#include "AmigaTypes.h"
+
+class Amiga;
+class Snapshot;
+
+/* The lockstep runner executes two emulator instances side by side to
+ * verify that a fast emulation path behaves exactly like the accurate one.
+ * Both instances are started from the same snapshot and differ in a set of
+ * configuration options only (e.g., Blitter accuracy 0 vs. 2 or a turbo
+ * drive vs. a standard drive). After each frame, or after a configurable
+ * number of CPU instructions, the states of both instances are compared. On
+ * the first divergence, the runner dumps the state of all differing
+ * components and the most recently executed instructions of both instances.
+ *
+ * Configuration options are part of the serialized component state. To keep
+ * them from being reported as a difference, the components are hashed with
+ * all configuration items masked out. Both instances are never reconfigured
+ * while they are running.
+ */
+class LockstepRunner : public AmigaObject {
+
+    // The two emulator instances
+    Amiga *a = NULL;
+    Amiga *b = NULL;
+
+    // Configuration options applied to instance A and instance B
+    vector<pair<ConfigOption,long>> optionsA;
+    vector<pair<ConfigOption,long>> optionsB;
+
+    /* Number of CPU instructions between two comparisons.
+     * If 0, the states are compared at the beginning of each frame.
+     */
+    long granularity = 0;
+
+    // Number of comparisons performed so far
+    long steps = 0;
+
+    // Number of logged instructions printed when a divergence is found
+    int traceLength = 32;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    LockstepRunner();
+    ~LockstepRunner();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    // Registers a configuration option that differs between both instances
+    void configureA(ConfigOption option, long value);
+    void configureB(ConfigOption option, long value);
+
+    // Sets the number of CPU instructions between two comparisons
+    void setGranularity(long instructions) { granularity = instructions; }
+
+    // Sets the number of instructions printed when a divergence is found
+    void setTraceLength(int value) { traceLength = value; }
+
+
+    //
+    // Running
+    //
+
+public:
+
+    /* Creates both instances and restores the provided snapshot.
+     * Returns false if the snapshot cannot be read or the emulator cannot be
+     * powered on.
+     */
+    bool setup(const char *snapshot);
+
+    /* Advances both instances by the specified number of steps.
+     * Returns the number of the first diverging step or -1 if both instances
+     * are still in sync.
+     */
+    long run(long count);
+
+private:
+
+    // Creates a single instance and restores the provided snapshot
+    Amiga *launch(Snapshot *snapshot, vector<pair<ConfigOption,long>> &options);
+
+    // Advances a single instance to the next comparison point
+    void step(Amiga *amiga);
+
+    // Computes a hash value for each component of an instance
+    void hash(Amiga *amiga, vector<uint64_t> &result);
+
+    // Reports a divergence
+    void report(vector<uint64_t> &hashA, vector<uint64_t> &hashB);
+
+    // Prints the most recently executed instructions of an instance
+    void dumpTrace(Amiga *amiga);
+
+    // Prints the first differing Ram location
+    void dumpRamDifference();
+};
+
+#endif
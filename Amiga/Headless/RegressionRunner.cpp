@@ -0,0 +1,257 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "RegressionRunner.h"
+
+RegressionRunner::RegressionRunner()
+{
+    setDescription("RegressionRunner");
+}
+
+RegressionRunner::~RegressionRunner()
+{
+    for (RegressionJob &job : jobs) {
+        free((void *)job.snapshot);
+        free((void *)job.golden);
+    }
+}
+
+void
+RegressionRunner::addJob(const char *snapshot, const char *golden, long frames)
+{
+    assert(snapshot != NULL);
+    assert(golden != NULL);
+
+    RegressionJob job;
+    memset(&job, 0, sizeof(job));
+
+    job.snapshot = strdup(snapshot);
+    job.golden = strdup(golden);
+    job.frames = frames;
+    job.divergence = -1;
+
+    jobs.push_back(job);
+}
+
+unsigned
+RegressionRunner::run(unsigned threads)
+{
+    runWorkers(threads, jobs.size());
+
+    unsigned failed = 0;
+    for (RegressionJob &job : jobs) if (!job.passed) failed++;
+    return failed;
+}
+
+void
+RegressionRunner::report()
+{
+    unsigned failed = 0;
+
+    for (RegressionJob &job : jobs) {
+
+        if (job.error) {
+            msg("ERROR  %s: %s\n", job.snapshot, job.error);
+        } else if (job.passed) {
+            msg("PASS   %s (%ld frames)\n", job.snapshot, job.frames);
+        } else {
+            msg("FAIL   %s: Diverging in frame %ld\n", job.snapshot, job.divergence);
+            msg("       State: expected %016llx, got %016llx\n",
+                (unsigned long long)job.expectedState,
+                (unsigned long long)job.computedState);
+            msg("       Frame: expected %016llx, got %016llx\n",
+                (unsigned long long)job.expectedFrame,
+                (unsigned long long)job.computedFrame);
+        }
+        if (profile && !job.error) reportBlitter(job);
+        if (profile && !job.error) reportCopper(job);
+        if (!job.passed) failed++;
+    }
+    msg("%zu tests, %d failed\n", jobs.size(), failed);
+}
+
+void
+RegressionRunner::workerLoop()
+{
+    size_t nr;
+    while (claimJob(nr)) runJob(jobs[nr]);
+}
+
+void
+RegressionRunner::runJob(RegressionJob &job)
+{
+    job.passed = false;
+    job.divergence = -1;
+    job.error = NULL;
+
+    Snapshot *snapshot = Snapshot::makeWithFile(job.snapshot);
+    if (!snapshot) {
+        job.error = "Cannot read snapshot";
+        return;
+    }
+
+    FILE *file = fopen(job.golden, record ? "w" : "r");
+    if (!file) {
+        job.error = record ? "Cannot create golden file" : "Cannot open golden file";
+        delete snapshot;
+        return;
+    }
+
+    Amiga *amiga = new Amiga();
+
+    /* Powering on requires a Rom which is why the snapshot is restored first.
+     * Because powerOn() resets all components, it is restored a second time
+     * afterwards.
+     */
+    amiga->loadFromSnapshotUnsafe(snapshot);
+    amiga->powerOn();
+    amiga->loadFromSnapshotUnsafe(snapshot);
+
+    if (amiga->isPoweredOn()) {
+
+        // Run as fast as possible
+        amiga->warpOn();
+        amiga->agnus.blitter.clearStats();
+        amiga->agnus.copper.clearStats();
+        runFrames(amiga, job, file);
+        job.blitter = amiga->agnus.blitter.getStats();
+        job.copper = amiga->agnus.copper.getStats();
+
+    } else {
+        job.error = "Cannot power up the emulator";
+    }
+
+    delete amiga;
+    delete snapshot;
+    fclose(file);
+}
+
+void
+RegressionRunner::runFrames(Amiga *amiga, RegressionJob &job, FILE *file)
+{
+    for (long i = 0; i < job.frames; i++) {
+
+        amiga->executeFrame();
+
+        uint64_t state = amiga->stateHash();
+        uint64_t frame = amiga->frameHash();
+
+        if (record) {
+
+            fprintf(file, "%ld %016llx %016llx\n",
+                    i, (unsigned long long)state, (unsigned long long)frame);
+            continue;
+        }
+
+        long nr = -1;
+        unsigned long long expectedState = 0, expectedFrame = 0;
+
+        if (fscanf(file, "%ld %llx %llx", &nr, &expectedState, &expectedFrame) != 3) {
+            nr = -1;
+        }
+
+        if (nr != i || expectedState != state || expectedFrame != frame) {
+
+            job.divergence = i;
+            job.expectedState = expectedState;
+            job.expectedFrame = expectedFrame;
+            job.computedState = state;
+            job.computedFrame = frame;
+            return;
+        }
+    }
+
+    job.passed = true;
+}
+
+void
+RegressionRunner::reportBlitter(RegressionJob &job)
+{
+    BlitterStats &stats = job.blitter;
+    long blits = stats.copyBlits + stats.lineBlits;
+    long frames = MAX(job.frames, 1L);
+
+    msg("       Blitter: %ld copy blits, %ld line blits (%.1f per frame)\n",
+        stats.copyBlits, stats.lineBlits, (double)blits / frames);
+    msg("                %ld words, %ld cycles, %ld stolen DMA cycles\n",
+        stats.words, stats.cycles, stats.stolen);
+    msg("       Engines: fast %ld, fake %ld, slow %ld\n",
+        stats.engine[BLT_ENGINE_FAST],
+        stats.engine[BLT_ENGINE_FAKE],
+        stats.engine[BLT_ENGINE_SLOW]);
+
+    // Size classes (number of words)
+    msg("         Sizes:");
+    for (int i = 0; i < BLT_SIZE_CLASSES; i++) {
+        if (i < BLT_SIZE_CLASSES - 1) {
+            plainmsg(" <%ld: %ld", 16L << (2 * i), stats.size[i]);
+        } else {
+            plainmsg(" more: %ld", stats.size[i]);
+        }
+    }
+    plainmsg("\n");
+
+    // Channel combinations (ABCD)
+    msg("      Channels:");
+    for (int i = 0; i < 16; i++) {
+        if (stats.channels[i] == 0) continue;
+        plainmsg(" %c%c%c%c: %ld",
+            (i & 8) ? 'A' : '-', (i & 4) ? 'B' : '-',
+            (i & 2) ? 'C' : '-', (i & 1) ? 'D' : '-', stats.channels[i]);
+    }
+    plainmsg("\n");
+
+    // Most frequently used minterms of copy blits
+    msg("      Minterms:");
+    bool shown[256] = { };
+    for (int n = 0; n < 8; n++) {
+
+        int best = -1;
+        for (int i = 0; i < 256; i++) {
+            if (!shown[i] && stats.minterm[i] &&
+                (best < 0 || stats.minterm[i] > stats.minterm[best])) best = i;
+        }
+        if (best < 0) break;
+
+        shown[best] = true;
+        plainmsg(" %02X: %ld", best, stats.minterm[best]);
+    }
+    plainmsg("\n");
+}
+
+void
+RegressionRunner::reportCopper(RegressionJob &job)
+{
+    CopperStats &stats = job.copper;
+    long commands = stats.moves + stats.waits + stats.skips + stats.precomputed;
+    long frames = MAX(job.frames, 1L);
+
+    msg("        Copper: %ld moves, %ld waits, %ld skips (%.1f commands per frame)\n",
+        stats.moves, stats.waits, stats.skips, (double)commands / frames);
+    msg("                %ld precomputed, %ld blocked cycles, %ld illegal moves\n",
+        stats.precomputed, stats.blocked, stats.violations);
+
+    // Rasterlines with the highest number of commands (average per frame)
+    msg("         Lines:");
+    bool shown[COP_LINES] = { };
+    for (int n = 0; n < 8; n++) {
+
+        int best = -1;
+        for (int i = 0; i < COP_LINES; i++) {
+            if (!shown[i] && stats.lines[i] &&
+                (best < 0 || stats.lines[i] > stats.lines[best])) best = i;
+        }
+        if (best < 0) break;
+
+        shown[best] = true;
+        plainmsg(" %d: %.1f", best, (double)stats.lines[best] / frames);
+    }
+    plainmsg("\n");
+}
@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _REGRESSION_RUNNER_INC
+#define _REGRESSION_RUNNER_INC
+
+#include "WorkerPool.h"
+#include "AmigaTypes.h"
+
+class Amiga;
+
+// A single regression test
+typedef struct {
+
+    // Snapshot the test starts with
+    const char *snapshot;
+
+    // File storing the expected hash values (one line per frame)
+    const char *golden;
+
+    // Number of frames to emulate
+    long frames;
+
+    // Indicates if the test has been executed successfully
+    bool passed;
+
+    // First frame with a mismatching hash value (-1 if none)
+    long divergence;
+
+    // Expected and computed hash values of the first diverging frame
+    uint64_t expectedState, computedState;
+    uint64_t expectedFrame, computedFrame;
+
+    // Error message if the test could not be executed (NULL if none)
+    const char *error;
+
+    // Blitter and Copper statistics collected while running the test
+    BlitterStats blitter;
+    CopperStats copper;
+
+} RegressionJob;
+
+/* The regression runner executes a set of regression tests without a GUI.
+ * Each test restores a snapshot in a newly created Amiga and emulates a
+ * certain number of frames in warp mode. At the end of each frame, the state
+ * hash and the frame buffer hash are computed and compared with the values
+ * recorded in a golden file. If the values differ, the test stops and the
+ * first diverging frame is reported. In record mode, the golden files are
+ * written instead.
+ *
+ * Tests are independent from each other and are distributed over a pool of
+ * worker threads.
+ */
+class RegressionRunner : public WorkerPool {
+
+    // All registered tests
+    vector<RegressionJob> jobs;
+
+    // If true, golden files are written instead of being compared
+    bool record = false;
+
+    // If true, the report includes the Blitter and Copper statistics of each test
+    bool profile = false;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    RegressionRunner();
+    ~RegressionRunner();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    // Registers a test
+    void addJob(const char *snapshot, const char *golden, long frames);
+
+    // Enables or disables record mode
+    void setRecordMode(bool value) { record = value; }
+
+    // Enables or disables the Blitter and Copper profile in the report
+    void setProfileMode(bool value) { profile = value; }
+
+
+    //
+    // Running tests
+    //
+
+public:
+
+    /* Executes all registered tests using the specified number of threads.
+     * Returns the number of failed tests.
+     */
+    unsigned run(unsigned threads);
+
+    // Prints the results of the most recent run
+    void report();
+
+    // Returns the results of the most recent run
+    vector<RegressionJob> &getJobs() { return jobs; }
+
+    // Picks up tests until all tests are done
+    void workerLoop() override;
+
+private:
+
+    // Executes a single test
+    void runJob(RegressionJob &job);
+
+    // Emulates all frames of a test and records or compares hash values
+    void runFrames(Amiga *amiga, RegressionJob &job, FILE *file);
+
+    // Prints the Blitter statistics of a test
+    void reportBlitter(RegressionJob &job);
+
+    // Prints the Copper statistics of a test
+    void reportCopper(RegressionJob &job);
+};
+
+#endif
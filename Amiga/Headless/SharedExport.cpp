@@ -0,0 +1,319 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "SharedExport.h"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+
+//
+// SharedExport
+//
+
+SharedExport::SharedExport()
+{
+    setDescription("SharedExport");
+
+    name[0] = 0;
+}
+
+SharedExport::~SharedExport()
+{
+    detach();
+}
+
+bool
+SharedExport::attach(Amiga *amiga, const char *name)
+{
+    static std::atomic<int> instances { 0 };
+
+    assert(amiga != NULL);
+
+    if (isAttached()) detach();
+
+    // Choose a unique name if none is given
+    if (name) {
+        snprintf(this->name, sizeof(this->name), "%s", name);
+    } else {
+        snprintf(this->name, sizeof(this->name), "/vAmiga.%d.%d", getpid(), instances++);
+    }
+
+    // Create the shared memory region
+    int fd = shm_open(this->name, O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+        warn("Cannot create shared memory object %s (%s)\n", this->name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SharedExportData)) != 0) {
+        warn("Cannot resize shared memory object %s (%s)\n", this->name, strerror(errno));
+        ::close(fd);
+        shm_unlink(this->name);
+        return false;
+    }
+    void *addr = mmap(NULL, sizeof(SharedExportData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        warn("Cannot map shared memory object %s (%s)\n", this->name, strerror(errno));
+        shm_unlink(this->name);
+        return false;
+    }
+
+    // Initialize the header (the magic number is written last)
+    data = (SharedExportData *)addr;
+    data->version = SHARED_EXPORT_VERSION;
+    data->size = sizeof(SharedExportData);
+    data->pid = getpid();
+    data->sampleRate = (uint32_t)amiga->paula.audioUnit.getSampleRate();
+    for (int i = 0; i < 2; i++) data->frame[i].sequence.store(0);
+    data->latest.store(0);
+    data->samplesWritten.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    data->magic = SHARED_EXPORT_MAGIC;
+
+    fullCopy[0] = fullCopy[1] = true;
+
+    // Attach to the emulator
+    amiga->suspend();
+    audioPtr = amiga->paula.audioUnit.getWritePtr();
+    amiga->setSharedExport(this);
+    this->amiga = amiga;
+    amiga->resume();
+
+    debug("Exporting to %s\n", this->name);
+    return true;
+}
+
+void
+SharedExport::detach()
+{
+    if (!isAttached()) return;
+
+    // Detach from the emulator
+    amiga->suspend();
+    amiga->setSharedExport(NULL);
+    amiga->resume();
+    amiga = NULL;
+
+    // Remove the shared memory region (mapped readers keep their mapping)
+    data->magic = 0;
+    munmap(data, sizeof(SharedExportData));
+    shm_unlink(name);
+    data = NULL;
+}
+
+void
+SharedExport::publishFrame(ScreenBuffer *buffer, IndexedFrame *indexed, uint64_t frameNr)
+{
+    assert(isAttached());
+
+    int type = buffer->longFrame ? 0 : 1;
+    SharedFrame &frame = data->frame[type];
+    uint64_t seq = frame.sequence.load(std::memory_order_relaxed);
+
+    // Enter the write phase
+    frame.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    frame.frameNr = frameNr;
+    frame.longFrame = buffer->longFrame;
+    frame.interlace = buffer->interlace;
+
+    // Copy all dirty lines
+    for (int w = 0; w < SHARED_DIRTY_WORDS; w++) {
+
+        uint64_t bits = fullCopy[type] ? ~0ULL : buffer->dirty[w];
+        frame.dirty[w] = bits;
+
+        for (; bits; bits &= bits - 1) {
+
+            int line = 64 * w + __builtin_ctzll(bits);
+            if (line >= VPIXELS) break;
+
+            int32_t *dst = frame.pixels + line * HPIXELS;
+            if (indexed) {
+                amiga->denise.pixelEngine.expandLine(indexed, line, dst);
+            } else {
+                memcpy(dst, buffer->data + line * HPIXELS, HPIXELS * sizeof(int32_t));
+            }
+            frame.lineFrame[line] = frameNr;
+        }
+    }
+    fullCopy[type] = false;
+
+    // Leave the write phase
+    frame.sequence.store(seq + 2, std::memory_order_release);
+    data->latest.store(type, std::memory_order_release);
+
+    publishAudio();
+}
+
+void
+SharedExport::publishAudio()
+{
+    AudioUnit &audioUnit = amiga->paula.audioUnit;
+
+    uint32_t size = (uint32_t)audioUnit.ringbufferSize();
+    uint32_t writePtr = audioUnit.getWritePtr();
+    uint32_t count = (writePtr + size - audioPtr) % size;
+
+    /* If the write pointer has been realigned by the audio unit, the distance
+     * is meaningless. In this case, we resynchronize and skip the samples.
+     */
+    if (count > size / 2) {
+        audioPtr = writePtr;
+        return;
+    }
+
+    uint64_t written = data->samplesWritten.load(std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < count; i++) {
+
+        uint32_t pos = (uint32_t)((written + i) % SHARED_AUDIO_CAPACITY);
+        data->left[pos] = audioUnit.getSampleL(audioPtr);
+        data->right[pos] = audioUnit.getSampleR(audioPtr);
+        audioPtr = (audioPtr + 1) % size;
+    }
+
+    data->samplesWritten.store(written + count, std::memory_order_release);
+}
+
+
+//
+// SharedExportReader
+//
+
+SharedExportReader::SharedExportReader()
+{
+    setDescription("SharedExportReader");
+}
+
+SharedExportReader::~SharedExportReader()
+{
+    close();
+}
+
+bool
+SharedExportReader::open(const char *name)
+{
+    assert(name != NULL);
+
+    close();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        warn("Cannot open shared memory object %s (%s)\n", name, strerror(errno));
+        return false;
+    }
+    void *addr = mmap(NULL, sizeof(SharedExportData), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        warn("Cannot map shared memory object %s (%s)\n", name, strerror(errno));
+        return false;
+    }
+
+    data = (const SharedExportData *)addr;
+    if (data->magic != SHARED_EXPORT_MAGIC ||
+        data->version != SHARED_EXPORT_VERSION ||
+        data->size != sizeof(SharedExportData)) {
+
+        warn("%s is not a compatible shared memory object\n", name);
+        close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    for (int i = 0; i < 2; i++) {
+        pixels[i] = new int32_t[HPIXELS * VPIXELS]();
+        lastFrame[i] = UINT64_MAX;
+    }
+    samplesRead = data->samplesWritten.load(std::memory_order_acquire);
+
+    return true;
+}
+
+void
+SharedExportReader::close()
+{
+    if (data) {
+        munmap((void *)data, sizeof(SharedExportData));
+        data = NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        delete [] pixels[i];
+        pixels[i] = NULL;
+    }
+}
+
+const int32_t *
+SharedExportReader::readFrame(uint64_t *frameNr, bool *longFrame)
+{
+    assert(isOpen());
+
+    int type = data->latest.load(std::memory_order_acquire);
+    const SharedFrame &frame = data->frame[type];
+
+    while (1) {
+
+        uint64_t seq = frame.sequence.load(std::memory_order_acquire);
+
+        // Wait until the emulator has finished writing
+        if (seq & 1) { sched_yield(); continue; }
+
+        // Check if there is anything new
+        if (seq == 0 || frame.frameNr == lastFrame[type]) return NULL;
+
+        uint64_t nr = frame.frameNr;
+        bool full = lastFrame[type] == UINT64_MAX;
+
+        // Copy all lines that changed since the last read
+        for (int line = 0; line < VPIXELS; line++) {
+
+            if (full || frame.lineFrame[line] > lastFrame[type]) {
+                memcpy(pixels[type] + line * HPIXELS,
+                       frame.pixels + line * HPIXELS,
+                       HPIXELS * sizeof(int32_t));
+            }
+        }
+
+        // Retry if the emulator has modified the frame in the meantime
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (frame.sequence.load(std::memory_order_relaxed) != seq) continue;
+
+        lastFrame[type] = nr;
+        if (frameNr) *frameNr = nr;
+        if (longFrame) *longFrame = type == 0;
+        return pixels[type];
+    }
+}
+
+size_t
+SharedExportReader::readAudio(float *left, float *right, size_t n)
+{
+    assert(isOpen());
+
+    uint64_t written = data->samplesWritten.load(std::memory_order_acquire);
+
+    // Skip the samples that have already been overwritten
+    if (written - samplesRead > SHARED_AUDIO_CAPACITY) {
+        samplesRead = written - SHARED_AUDIO_CAPACITY;
+    }
+
+    size_t count = MIN(n, (size_t)(written - samplesRead));
+
+    for (size_t i = 0; i < count; i++) {
+
+        size_t pos = (samplesRead + i) % SHARED_AUDIO_CAPACITY;
+        left[i] = data->left[pos];
+        right[i] = data->right[pos];
+    }
+
+    samplesRead += count;
+    return count;
+}
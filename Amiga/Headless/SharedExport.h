@@ -0,0 +1,207 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _SHARED_EXPORT_INC
+#define _SHARED_EXPORT_INC
+
+#include "AmigaObject.h"
+#include "DeniseTypes.h"
+#include <atomic>
+
+class Amiga;
+struct IndexedFrame;
+
+//
+// Shared memory layout
+//
+
+#define SHARED_EXPORT_MAGIC    0x76416D53 // 'vAmS'
+#define SHARED_EXPORT_VERSION  1
+#define SHARED_AUDIO_CAPACITY  16384
+#define SHARED_DIRTY_WORDS     ((VPIXELS + 63) / 64)
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared memory requires address-free atomics");
+
+/* A frame stored in shared memory. The frame is protected by a sequence lock:
+ * The sequence number is odd while the emulator is writing the frame. A
+ * reader copies the data and verifies that the sequence number is even and
+ * has not changed in the meantime.
+ */
+typedef struct
+{
+    std::atomic<uint64_t> sequence;
+
+    // Frame number and type of the stored frame
+    uint64_t frameNr;
+    bool longFrame;
+    bool interlace;
+
+    // Lines that differ from the previous frame of the same type
+    uint64_t dirty[SHARED_DIRTY_WORDS];
+
+    // Frame number of the most recent change of each line
+    uint64_t lineFrame[VPIXELS];
+
+    // Pixel data (RGBA)
+    int32_t pixels[HPIXELS * VPIXELS];
+}
+SharedFrame;
+
+/* The complete shared memory region. Long frames and short frames are stored
+ * separately, mirroring the frame buffers of the pixel engine. Hence, only
+ * the lines marked as dirty need to be copied. Audio samples are stored in a
+ * ring buffer that is indexed by the total number of written samples.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    int32_t pid;
+
+    // Frames (0 = long frame, 1 = short frame)
+    SharedFrame frame[2];
+
+    // Index of the most recently completed frame
+    std::atomic<uint32_t> latest;
+
+    // Audio ring buffer
+    uint32_t sampleRate;
+    std::atomic<uint64_t> samplesWritten;
+    float left[SHARED_AUDIO_CAPACITY];
+    float right[SHARED_AUDIO_CAPACITY];
+}
+SharedExportData;
+
+
+/* The shared export publishes the output of an Amiga in a POSIX shared memory
+ * region that can be mapped by other processes. Each attached Amiga uses its
+ * own region. By default, the region is named "/vAmiga.<pid>.<n>" where n
+ * enumerates the exports of a process.
+ *
+ * The export is driven by the emulator thread at the end of each frame. It
+ * never blocks and never waits for a reader. Only the dirty lines of a frame
+ * are copied into the region, together with all audio samples that have been
+ * written into the audio ring buffer since the previous frame.
+ */
+class SharedExport : public AmigaObject {
+
+    // The Amiga the export is attached to (NULL if detached)
+    Amiga *amiga = NULL;
+
+    // Name of the shared memory object
+    char name[64];
+
+    // The mapped shared memory region
+    SharedExportData *data = NULL;
+
+    // Indicates if a frame area has to be copied completely
+    bool fullCopy[2] = { true, true };
+
+    // Position in the audio ring buffer of the audio unit
+    uint32_t audioPtr = 0;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    SharedExport();
+    ~SharedExport();
+
+
+    //
+    // Attaching and detaching
+    //
+
+public:
+
+    /* Creates the shared memory region and attaches the export to an Amiga.
+     * If name is NULL, a unique name is chosen. Returns false if the region
+     * could not be created.
+     */
+    bool attach(Amiga *amiga, const char *name = NULL);
+
+    // Detaches the export and removes the shared memory region
+    void detach();
+
+    // Indicates if the export is attached
+    bool isAttached() { return amiga != NULL; }
+
+    // Returns the name of the shared memory object
+    const char *getName() { return name; }
+
+
+    //
+    // Exporting
+    //
+
+public:
+
+    /* Publishes a finished frame. This function is called by the emulator
+     * thread at the end of each frame. If the pixel engine runs in indexed
+     * mode, indexed points to the indexed version of the frame.
+     */
+    void publishFrame(ScreenBuffer *buffer, IndexedFrame *indexed, uint64_t frameNr);
+
+private:
+
+    // Copies all new samples of the audio unit into the shared ring buffer
+    void publishAudio();
+};
+
+
+/* Minimal reference implementation of a reader. The reader maps the shared
+ * memory region of an export read-only and can be used from any process.
+ */
+class SharedExportReader : public AmigaObject {
+
+    // The mapped shared memory region
+    const SharedExportData *data = NULL;
+
+    // Local copies of the long frame and the short frame
+    int32_t *pixels[2] = { NULL, NULL };
+
+    // Frame number of the most recently read frame of each type
+    uint64_t lastFrame[2] = { UINT64_MAX, UINT64_MAX };
+
+    // Number of audio samples read so far
+    uint64_t samplesRead = 0;
+
+public:
+
+    SharedExportReader();
+    ~SharedExportReader();
+
+    // Maps the shared memory region with the specified name
+    bool open(const char *name);
+
+    // Unmaps the shared memory region
+    void close();
+
+    // Indicates if a region is mapped
+    bool isOpen() { return data != NULL; }
+
+    /* Reads the most recent frame. Only the lines that changed since the
+     * last frame of the same type was read are copied. Returns a buffer of
+     * HPIXELS * VPIXELS pixels which stays valid until the next call, or NULL
+     * if no new frame is available.
+     */
+    const int32_t *readFrame(uint64_t *frameNr = NULL, bool *longFrame = NULL);
+
+    /* Reads up to n stereo samples. Returns the number of read samples. If
+     * the reader has fallen behind, the oldest samples are skipped.
+     */
+    size_t readAudio(float *left, float *right, size_t n);
+};
+
+#endif
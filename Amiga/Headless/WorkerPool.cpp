@@ -0,0 +1,70 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include "WorkerPool.h"
+
+void *
+workerThreadMain(void *thisPool) {
+
+    assert(thisPool != NULL);
+
+    WorkerPool *pool = (WorkerPool *)thisPool;
+    pool->workerLoop();
+
+    pthread_exit(NULL);
+}
+
+WorkerPool::WorkerPool()
+{
+    pthread_mutex_init(&lock, NULL);
+}
+
+WorkerPool::~WorkerPool()
+{
+    pthread_mutex_destroy(&lock);
+}
+
+void
+WorkerPool::runWorkers(unsigned threads, size_t jobs)
+{
+    vector<pthread_t> workers;
+
+    numJobs = jobs;
+    nextJob = 0;
+    if (threads < 1) threads = 1;
+    if (threads > jobs) threads = (unsigned)jobs;
+
+    // Launch the worker threads
+    for (unsigned i = 0; i < threads; i++) {
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, workerThreadMain, (void *)this) == 0) {
+            workers.push_back(thread);
+        } else {
+            warn("Failed to create worker thread %d\n", i);
+        }
+    }
+
+    // If no thread could be launched, run all jobs in the calling thread
+    if (workers.empty()) workerLoop();
+
+    // Wait until all jobs have been processed
+    for (pthread_t thread : workers) pthread_join(thread, NULL);
+}
+
+bool
+WorkerPool::claimJob(size_t &nr)
+{
+    pthread_mutex_lock(&lock);
+    nr = nextJob++;
+    pthread_mutex_unlock(&lock);
+
+    return nr < numJobs;
+}
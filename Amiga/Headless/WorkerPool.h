@@ -0,0 +1,65 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _WORKER_POOL_INC
+#define _WORKER_POOL_INC
+
+#include "AmigaObject.h"
+
+/* Base class of all headless runners that distribute independent jobs over a
+ * pool of worker threads. Each worker executes workerLoop() which repeatedly
+ * claims the next pending job until all jobs have been picked up. If no
+ * thread can be launched, all jobs are processed in the calling thread.
+ */
+class WorkerPool : public AmigaObject {
+
+    // Number of jobs processed by the current run
+    size_t numJobs = 0;
+
+    // Index of the next job to be picked up by a worker thread
+    size_t nextJob = 0;
+
+    // Protects nextJob
+    pthread_mutex_t lock;
+
+
+    //
+    // Constructing and destructing
+    //
+
+public:
+
+    WorkerPool();
+    virtual ~WorkerPool();
+
+
+    //
+    // Running jobs
+    //
+
+protected:
+
+    // Processes the specified number of jobs using up to 'threads' threads
+    void runWorkers(unsigned threads, size_t jobs);
+
+    /* Claims the next pending job.
+     * Returns false if all jobs have been picked up already.
+     */
+    bool claimJob(size_t &nr);
+
+public:
+
+    /* The thread enter function.
+     * Processes jobs until claimJob() fails. It has to be declared public to
+     * make it accessible by the worker threads.
+     */
+    virtual void workerLoop() = 0;
+};
+
+#endif